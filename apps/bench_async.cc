@@ -0,0 +1,75 @@
+#include "async.hh"
+#include "bench_util.hh"
+#include "eventloop.hh"
+#include "file_descriptor.hh"
+#include "util.hh"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <utility>
+
+using namespace std;
+
+//! Both ends of a non-blocking Unix-domain stream socket pair
+static pair<FileDescriptor, FileDescriptor> make_pair_of_fds() {
+    int fds[2];
+    SystemCall("socketpair", ::socketpair(AF_UNIX, SOCK_STREAM, 0, static_cast<int *>(fds)));
+    pair<FileDescriptor, FileDescriptor> ret{FileDescriptor{fds[0]}, FileDescriptor{fds[1]}};
+    ret.first.set_blocking(false);
+    ret.second.set_blocking(false);
+    return ret;
+}
+
+//! Send `rounds` one-byte messages on `out`, waiting for each to come back on `in`
+static Task<void> pinger(AsyncLoop &async, FileDescriptor &out, FileDescriptor &in, const size_t rounds) {
+    string buffer;
+    for (size_t i = 0; i < rounds; ++i) {
+        co_await async.write_all(out, "x");
+        if (co_await async.read_some(in, buffer, 1) != 1) {
+            throw runtime_error("bench_async: unexpected EOF");
+        }
+    }
+}
+
+//! Send each of `rounds` bytes received on `in` back on `out`
+static Task<void> ponger(AsyncLoop &async, FileDescriptor &in, FileDescriptor &out, const size_t rounds) {
+    string buffer;
+    for (size_t i = 0; i < rounds; ++i) {
+        if (co_await async.read_some(in, buffer, 1) != 1) {
+            throw runtime_error("bench_async: unexpected EOF");
+        }
+        co_await async.write_all(out, buffer);
+    }
+}
+
+//! Round trips between two coroutines over two socket pairs (every message waits in the EventLoop)
+static void ping_pong() {
+    EventLoop loop;
+    AsyncLoop async{loop};
+    auto [ping_in, ping_out] = make_pair_of_fds();
+    auto [pong_in, pong_out] = make_pair_of_fds();
+
+    const double rate = bench_rate([&] {
+        constexpr size_t ROUNDS = 256;
+        async.spawn(ponger(async, ping_in, pong_out, ROUNDS));
+        async.spawn(pinger(async, ping_out, pong_in, ROUNDS));
+        async.run();
+        return ROUNDS;
+    });
+    bench_report("async_ping_pong", rate, "round trips/s");
+}
+
+int main() {
+    try {
+        ping_pong();
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
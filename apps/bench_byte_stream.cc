@@ -0,0 +1,142 @@
+#include "bench_util.hh"
+#include "byte_stream.hh"
+#include "file_descriptor.hh"
+#include "util.hh"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+
+using namespace std;
+
+static constexpr size_t CAPACITY = 64000;
+
+//! Alternate writes and reads of `chunk` bytes, so the stream never holds more than one chunk
+static void write_read(const size_t chunk) {
+    ByteStream stream{CAPACITY};
+    const string data(chunk, 'x');
+    const double rate = bench_rate([&] {
+        size_t moved = 0;
+        for (unsigned i = 0; i < 256; ++i) {
+            stream.write(data);
+            moved += stream.read(chunk).size();
+        }
+        return moved;
+    });
+    bench_report("byte_stream_write_read_" + to_string(chunk), rate, "bytes/s");
+}
+
+//! Fill the stream to capacity in `chunk`-byte writes, then drain it in `chunk`-byte reads
+static void fill_drain(const size_t chunk) {
+    ByteStream stream{CAPACITY};
+    const string data(chunk, 'x');
+    const double rate = bench_rate([&] {
+        while (stream.remaining_capacity() > 0) {
+            stream.write(data);
+        }
+        size_t moved = 0;
+        while (not stream.buffer_empty()) {
+            moved += stream.read(chunk).size();
+        }
+        return moved;
+    });
+    bench_report("byte_stream_fill_drain_" + to_string(chunk), rate, "bytes/s");
+}
+
+//! \brief Move `chunk`-byte messages from a socket into the stream and out again
+//! \param[in] direct is whether to use ByteStream::fill_from (otherwise FileDescriptor::read, then write)
+static void from_fd(const size_t chunk, const bool direct) {
+    int fds[2];
+    SystemCall("socketpair", ::socketpair(AF_UNIX, SOCK_STREAM, 0, static_cast<int *>(fds)));
+    FileDescriptor in{fds[0]}, out{fds[1]};
+
+    ByteStream stream{CAPACITY};
+    const string data(chunk, 'x');
+    const double rate = bench_rate([&] {
+        size_t moved = 0;
+        for (unsigned i = 0; i < 64; ++i) {
+            out.write(data);
+            for (size_t got = 0; got < chunk;) {
+                got += direct ? stream.fill_from(in, chunk - got) : stream.write(in.read(chunk - got));
+            }
+            moved += stream.read(chunk).size();
+        }
+        if (moved != 64 * chunk) {
+            throw runtime_error("bench_byte_stream: lost bytes");
+        }
+        return moved;
+    });
+    bench_report(string("byte_stream_") + (direct ? "fill_from_fd_" : "read_write_fd_") + to_string(chunk),
+                 rate,
+                 "bytes/s");
+}
+
+//! \brief Relay `chunk`-byte writes from one stream to another and out of it, as a proxy would
+//! \param[in] chunked is whether to move Buffers with read_chunks/write(BufferList &&) (otherwise read, then write)
+static void relay(const size_t chunk, const bool chunked) {
+    ByteStream inbound{CAPACITY}, outbound{CAPACITY};
+    const string data(chunk, 'x');
+    const double rate = bench_rate([&] {
+        size_t moved = 0;
+        for (unsigned i = 0; i < 64; ++i) {
+            inbound.write(data);
+            if (chunked) {
+                outbound.write(inbound.read_chunks(chunk));
+            } else {
+                outbound.write(inbound.read(chunk));
+            }
+            moved += outbound.read_chunks(chunk).size();
+        }
+        if (moved != 64 * chunk) {
+            throw runtime_error("bench_byte_stream: lost bytes");
+        }
+        return moved;
+    });
+    bench_report(string("byte_stream_relay_") + (chunked ? "chunks_" : "copy_") + to_string(chunk), rate, "bytes/s");
+}
+
+//! \brief Write messages built from a header and a body, then read them back
+//! \param[in] views is whether to write the pieces as a BufferViewList (otherwise concatenate them first)
+static void gather(const size_t chunk, const bool views) {
+    constexpr size_t HEADER = 200;
+    ByteStream stream{CAPACITY};
+    const string header(HEADER, 'h');
+    const string body(chunk - HEADER, 'b');
+    const double rate = bench_rate([&] {
+        size_t moved = 0;
+        for (unsigned i = 0; i < 256; ++i) {
+            if (views) {
+                stream.write(BufferViewList{header, body});
+            } else {
+                stream.write(header + body);
+            }
+            moved += stream.read(chunk).size();
+        }
+        return moved;
+    });
+    bench_report(string("byte_stream_gather_") + (views ? "views_" : "concat_") + to_string(chunk), rate, "bytes/s");
+}
+
+int main() {
+    try {
+        write_read(1);
+        write_read(64);
+        write_read(1460);
+        fill_drain(1460);
+        fill_drain(16384);
+        from_fd(16384, false);
+        from_fd(16384, true);
+        relay(16384, false);
+        relay(16384, true);
+        gather(1460, false);
+        gather(1460, true);
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
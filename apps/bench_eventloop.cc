@@ -0,0 +1,179 @@
+#include "bench_util.hh"
+#include "eventloop.hh"
+#include "file_descriptor.hh"
+#include "util.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+//! Both ends of a Unix-domain socket pair (stream by default)
+static pair<FileDescriptor, FileDescriptor> make_pair_of_fds(const int type = SOCK_STREAM) {
+    int fds[2];
+    SystemCall("socketpair", ::socketpair(AF_UNIX, type, 0, static_cast<int *>(fds)));
+    return {FileDescriptor{fds[0]}, FileDescriptor{fds[1]}};
+}
+
+//! How the idle rules of one_busy_among are set up
+enum class Idle { Interested, Uninterested, Paused };
+
+//! \brief Measure wait_next_event() with one busy fd among `idle` fds that never become ready
+//! \param[in] idle is the number of additional rules on fds with nothing to read
+//! \param[in] mode is whether the idle rules ask to be polled, are placeholders, or are paused
+//! \param[in] busy_poll is whether the loop spins before blocking (the fd is always ready, so this
+//!                      measures the overhead of the spinning path)
+static void one_busy_among(const size_t idle, const Idle mode, const bool busy_poll = false) {
+    EventLoop loop;
+    if (busy_poll) {
+        loop.set_busy_poll(chrono::microseconds{50});
+    }
+    vector<pair<FileDescriptor, FileDescriptor>> pairs;
+    pairs.reserve(idle + 1);
+
+    for (size_t i = 0; i < idle + 1; ++i) {
+        pairs.push_back(make_pair_of_fds());
+    }
+
+    auto &[busy_in, busy_out] = pairs.front();
+    loop.add_rule(busy_in, Direction::In, [&] { busy_in.read(1); });
+    for (size_t i = 1; i < pairs.size(); ++i) {
+        const bool interested = mode != Idle::Uninterested;
+        auto handle = loop.add_rule(
+            pairs[i].first, Direction::In, [] {}, [interested] { return interested; });
+        if (mode == Idle::Paused) {
+            handle.pause();
+        }
+    }
+
+    const string one_byte = "x";
+    const double rate = bench_rate([&] {
+        size_t events = 0;
+        for (unsigned i = 0; i < 256; ++i) {
+            busy_out.write(one_byte);
+            if (loop.wait_next_event(1000) != EventLoop::Result::Success) {
+                throw runtime_error("bench_eventloop: expected an event");
+            }
+            ++events;
+        }
+        return events;
+    });
+    const char *prefix = mode == Idle::Interested ? "idle_" : mode == Idle::Uninterested ? "uninterested_" : "paused_";
+    bench_report(string("eventloop_") + prefix + to_string(idle) + (busy_poll ? "_busy_poll" : ""), rate, "events/s");
+}
+
+//! Pause and resume a rule around every event, as a connection does when its window closes and reopens
+static void pause_resume() {
+    EventLoop loop;
+    auto [in, out] = make_pair_of_fds();
+    auto handle = loop.add_rule(in, Direction::In, [&in = in] { in.read(1); });
+
+    const string one_byte = "x";
+    const double rate = bench_rate([&] {
+        size_t events = 0;
+        for (unsigned i = 0; i < 256; ++i) {
+            out.write(one_byte);
+            handle.pause();
+            handle.resume();
+            if (loop.wait_next_event(1000) != EventLoop::Result::Success) {
+                throw runtime_error("bench_eventloop: expected an event");
+            }
+            ++events;
+        }
+        return events;
+    });
+    bench_report("eventloop_pause_resume", rate, "events/s");
+}
+
+//! \brief Measure delivery of bursts of `burst` datagrams, read one per callback call
+//! \param[in] budget is the rule's drain budget (1: one datagram per wait_next_event)
+static void bursts(const size_t burst, const unsigned int budget) {
+    EventLoop loop;
+    auto [in, out] = make_pair_of_fds(SOCK_DGRAM);
+    in.set_blocking(false);
+    size_t received = 0;
+    string incoming;
+    auto handle = loop.add_rule(in, Direction::In, [&in = in, &received, &incoming] {
+        if (in.try_read(incoming, 2048)) {
+            received += incoming.size();
+        }
+    });
+    handle.set_drain_budget(budget);
+
+    const string datagram(64, 'x');
+    const double rate = bench_rate([&] {
+        received = 0;
+        for (size_t i = 0; i < burst; ++i) {
+            out.write(datagram);
+        }
+        while (received < burst * datagram.size()) {
+            if (loop.wait_next_event(1000) != EventLoop::Result::Success) {
+                throw runtime_error("bench_eventloop: expected an event");
+            }
+        }
+        return burst;
+    });
+    bench_report("eventloop_burst" + to_string(burst) + "_budget" + to_string(budget), rate, "datagrams/s");
+}
+
+//! Post batches of `batch` functions and run them with one wait_next_event (one eventfd wakeup per batch)
+static void post_batches(const size_t batch) {
+    EventLoop loop;
+    auto [in, out] = make_pair_of_fds();
+    loop.add_rule(in, Direction::In, [&in = in] { in.read(1); });  // never ready: only posts wake the loop
+
+    size_t ran = 0;
+    const double rate = bench_rate([&] {
+        ran = 0;
+        for (size_t i = 0; i < batch; ++i) {
+            loop.post([&ran] { ++ran; });
+        }
+        if (loop.wait_next_event(1000) != EventLoop::Result::Success or ran != batch) {
+            throw runtime_error("bench_eventloop: posted functions did not run");
+        }
+        return batch;
+    });
+    bench_report("eventloop_post_batch" + to_string(batch), rate, "posts/s");
+}
+
+//! Register `count` rules on one fd in a fresh EventLoop (which then polls them once and discards them)
+static void add_rules(const size_t count) {
+    auto [in, out] = make_pair_of_fds();
+    const double rate = bench_rate([&] {
+        EventLoop loop;
+        for (size_t i = 0; i < count; ++i) {
+            loop.add_rule(
+                in, Direction::In, [&in] { in.read(1); }, [&in] { return not in.eof(); });
+        }
+        return count;
+    });
+    bench_report("eventloop_add_rule_" + to_string(count), rate, "rules/s");
+}
+
+int main() {
+    try {
+        one_busy_among(0, Idle::Interested);
+        one_busy_among(0, Idle::Interested, true);
+        one_busy_among(64, Idle::Interested);
+        one_busy_among(256, Idle::Interested);
+        one_busy_among(256, Idle::Uninterested);
+        one_busy_among(256, Idle::Paused);
+        pause_resume();
+        bursts(16, 1);
+        bursts(16, 64);
+        post_batches(64);
+        add_rules(1024);
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
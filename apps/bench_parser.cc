@@ -0,0 +1,100 @@
+#include "bench_util.hh"
+#include "ipv4_header.hh"
+#include "parser.hh"
+#include "tcp_header.hh"
+#include "util.hh"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+//! Build a serialized IPv4 datagram carrying a TCP segment with `payload_size` bytes, with valid checksums
+static string make_datagram(const size_t payload_size) {
+    const string payload(payload_size, 'x');
+
+    IPv4Header ip{};
+    ip.len = IPv4Header::LENGTH + TCPHeader::LENGTH + payload.size();
+    ip.src = 0x0a000001;
+    ip.dst = 0x0a000002;
+    ip.cksum = 0;
+    {
+        InternetChecksum check;
+        check.add(ip.serialize());
+        ip.cksum = check.value();
+    }
+
+    TCPHeader tcp{};
+    tcp.sport = 1234;
+    tcp.dport = 80;
+    tcp.seqno = WrappingInt32{0x12345678};
+    tcp.ack = true;
+    tcp.win = 65535;
+    {
+        InternetChecksum check{ip.pseudo_cksum()};
+        check.add(tcp.serialize());
+        check.add(payload);
+        tcp.cksum = check.value();
+    }
+
+    return ip.serialize() + tcp.serialize() + payload;
+}
+
+//! Parse the IPv4 header (including its checksum) and the TCP header of the same datagram, repeatedly
+static void parse_headers(const Buffer &datagram) {
+    const double rate = bench_rate([&] {
+        size_t parsed = 0;
+        for (unsigned i = 0; i < 1024; ++i) {
+            NetParser p{datagram};
+            IPv4Header ip{};
+            TCPHeader tcp{};
+            if (ip.parse(p) != ParseResult::NoError or tcp.parse(p) != ParseResult::NoError) {
+                throw runtime_error("bench_parser: generated datagram did not parse");
+            }
+            parsed += tcp.win != 0;
+        }
+        return parsed;
+    });
+    bench_report("parse_ipv4_tcp_headers", rate, "segments/s");
+}
+
+//! Verify the TCP checksum (pseudo-header plus segment) of a datagram with `payload_size` payload bytes
+static void tcp_checksum(const size_t payload_size) {
+    const Buffer datagram{make_datagram(payload_size)};
+    IPv4Header ip{};
+    NetParser p{datagram};
+    if (ip.parse(p) != ParseResult::NoError) {
+        throw runtime_error("bench_parser: generated datagram did not parse");
+    }
+    const Buffer segment = p.buffer();
+
+    const double rate = bench_rate([&] {
+        size_t checked = 0;
+        for (unsigned i = 0; i < 64; ++i) {
+            InternetChecksum check{ip.pseudo_cksum()};
+            check.add(segment);
+            if (check.value() != 0) {
+                throw runtime_error("bench_parser: generated datagram has a bad checksum");
+            }
+            checked += segment.size();
+        }
+        return checked;
+    });
+    bench_report("tcp_checksum_" + to_string(payload_size), rate, "bytes/s");
+}
+
+int main() {
+    try {
+        parse_headers(Buffer{make_datagram(1460)});
+        tcp_checksum(64);
+        tcp_checksum(1460);
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,158 @@
+#include "bench_util.hh"
+#include "reassembly_batch.hh"
+#include "stream_reassembler.hh"
+
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+static constexpr size_t CAPACITY = 64000;
+
+//! A substring of the stream: (index, length)
+using Piece = tuple<size_t, size_t>;
+
+//! Split [0, total) into consecutive pieces with lengths drawn from [min_len, max_len]
+static vector<Piece> make_pieces(const size_t total, const size_t min_len, const size_t max_len, mt19937 &rd) {
+    vector<Piece> pieces;
+    for (size_t offset = 0; offset < total;) {
+        const size_t len = min(total - offset, min_len + rd() % (max_len - min_len + 1));
+        pieces.emplace_back(offset, len);
+        offset += len;
+    }
+    return pieces;
+}
+
+//! \brief Push `pieces` (relative to the start of a window) into a reassembler, window by window
+//! \details Each call of the measured operation pushes one window's worth of pieces starting at the
+//! reassembler's current position, then drains the output, so the stream can run indefinitely.
+//! \param[in] slices pushes each piece as a Buffer sharing one allocation (as a segment's payload
+//! would arrive) instead of as a string
+static void run(const string &name, vector<Piece> pieces, const size_t window, const bool slices = false) {
+    StreamReassembler reassembler{CAPACITY};
+    const string data(window, 'x');
+    const Buffer shared{string(data)};
+    uint64_t base = 0;
+    const double rate = bench_rate([&] {
+        for (const auto &[offset, len] : pieces) {
+            if (slices) {
+                Buffer piece = shared;
+                piece.remove_prefix(offset);
+                piece.remove_suffix(window - offset - len);
+                reassembler.push_substring(move(piece), base + offset, false);
+            } else {
+                reassembler.push_substring(data.substr(offset, len), base + offset, false);
+            }
+        }
+        auto &out = reassembler.stream_out();
+        const size_t moved = out.read(out.buffer_size()).size();
+        if (moved != window or not reassembler.empty()) {
+            throw runtime_error(name + ": reassembler did not deliver the whole window");
+        }
+        base += window;
+        return moved;
+    });
+    bench_report(name, rate, "bytes/s");
+}
+
+//! \brief Push segments of many flows, interleaved, as they would arrive from a busy link
+//! \details Each call of the measured operation sends `per_flow` 1460-byte segments on each of `flows`
+//! flows, in short reordered trains, in receive batches of 64, then drains every flow. With `batched`, each
+//! receive batch goes through a ReassemblyBatch instead of one push_substring() per segment.
+static void run_flows(const string &name, const size_t flows, const size_t per_flow, const bool batched, mt19937 &rd) {
+    constexpr size_t SEGMENT = 1460;
+    constexpr size_t RECV_BATCH = 64;
+    constexpr size_t TRAIN = 8;
+
+    vector<unique_ptr<StreamReassembler>> reassemblers;
+    for (size_t i = 0; i < flows; i++) {
+        reassemblers.push_back(make_unique<StreamReassembler>(CAPACITY));
+    }
+    // each flow sends trains of TRAIN segments; trains of different flows interleave at random, and
+    // the segments of a train are reordered among themselves (as by multipath or a multi-queue NIC)
+    vector<vector<pair<size_t, size_t>>> trains;  // (flow, segment)
+    for (size_t flow = 0; flow < flows; flow++) {
+        for (size_t segment = 0; segment < per_flow; segment++) {
+            if (segment % TRAIN == 0) {
+                trains.emplace_back();
+            }
+            trains.back().emplace_back(flow, segment);
+        }
+    }
+    shuffle(trains.begin(), trains.end(), rd);
+    vector<pair<size_t, size_t>> arrivals;
+    for (auto &train : trains) {
+        shuffle(train.begin(), train.end(), rd);
+        arrivals.insert(arrivals.end(), train.begin(), train.end());
+    }
+
+    const Buffer payload{string(SEGMENT, 'x')};
+    ReassemblyBatch batch;
+    uint64_t base = 0;
+    const double rate = bench_rate([&] {
+        for (size_t i = 0; i < arrivals.size(); i++) {
+            const auto [flow, segment] = arrivals[i];
+            if (batched) {
+                batch.add(*reassemblers[flow], payload, base + segment * SEGMENT, false);
+                if (batch.size() == RECV_BATCH or i + 1 == arrivals.size()) {
+                    batch.apply();
+                }
+            } else {
+                reassemblers[flow]->push_substring(payload, base + segment * SEGMENT, false);
+            }
+        }
+        size_t moved = 0;
+        for (auto &reassembler : reassemblers) {
+            auto &out = reassembler->stream_out();
+            moved += out.read_chunks(out.buffer_size()).size();
+        }
+        if (moved != flows * per_flow * SEGMENT) {
+            throw runtime_error(name + ": reassemblers did not deliver every segment");
+        }
+        base += per_flow * SEGMENT;
+        return moved;
+    });
+    bench_report(name, rate, "bytes/s");
+}
+
+int main() {
+    try {
+        mt19937 rd{144};  // fixed seed: every run measures the same arrival order
+        constexpr size_t WINDOW = 32 * 1460;
+
+        // bulk transfer, no loss
+        run("reassembler_in_order_1460", make_pieces(WINDOW, 1460, 1460, rd), WINDOW);
+
+        // bulk transfer, every window arriving in random order
+        auto shuffled = make_pieces(WINDOW, 1460, 1460, rd);
+        shuffle(shuffled.begin(), shuffled.end(), rd);
+        run("reassembler_reordered_1460", shuffled, WINDOW);
+        run("reassembler_reordered_1460_slices", shuffled, WINDOW, true);
+
+        // tiny segments in random order, plus a second overlapping copy of everything
+        constexpr size_t TINY_WINDOW = 4096;
+        auto tiny = make_pieces(TINY_WINDOW, 1, 10, rd);
+        auto overlap = make_pieces(TINY_WINDOW, 1, 10, rd);
+        tiny.insert(tiny.end(), overlap.begin(), overlap.end());
+        shuffle(tiny.begin(), tiny.end(), rd);
+        run("reassembler_tiny_overlapping", tiny, TINY_WINDOW);
+
+        // many flows sharing one link
+        run_flows("reassembler_flows_1024", 1024, 16, false, rd);
+        run_flows("reassembler_flows_1024_batched", 1024, 16, true, rd);
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,351 @@
+#include "bench_util.hh"
+#include "ipv4_header.hh"
+#include "parser.hh"
+#include "stream_reassembler.hh"
+#include "tcp_header.hh"
+#include "util.hh"
+#include "wrapping_integers.hh"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+static constexpr size_t DEFAULT_CAPACITY = 64000;  // same default window as TCPConfig
+
+//! \brief The stages of the receive path that the replay times separately
+enum Stage : size_t { Parse = 0, Checksum, Receive, Drain, NumStages };
+
+static constexpr array<const char *, NumStages> STAGE_NAMES = {"parse", "checksum", "receive", "drain"};
+
+//! Identifies one direction of one TCP connection
+struct FlowKey {
+    uint32_t src, dst;
+    uint16_t sport, dport;
+
+    bool operator<(const FlowKey &other) const {
+        return tie(src, dst, sport, dport) < tie(other.src, other.dst, other.sport, other.dport);
+    }
+};
+
+//! \brief The receiving side of one flow
+//! \details Maps seqnos to stream indices the way a TCPReceiver would: segments before the SYN are
+//! dropped, the SYN fixes the ISN, and every segment is unwrapped against the bytes written so far.
+struct Flow {
+    optional<WrappingInt32> isn{};
+    StreamReassembler reassembler;
+
+    explicit Flow(const size_t capacity) : reassembler(capacity) {}
+};
+
+//! Totals accumulated over all replays
+struct ReplayStats {
+    array<nanoseconds, NumStages> stage_time{};
+    uint64_t segments = 0;
+    uint64_t payload_bytes = 0;
+    uint64_t delivered_bytes = 0;
+    uint64_t bad_checksum = 0;
+    uint64_t parse_errors = 0;
+    uint64_t flows = 0;
+};
+
+//! \brief Read a classic (non-ng) pcap file and return the IPv4 datagrams it contains
+//! \details The whole capture is loaded into memory ahead of the replay so that file I/O is not measured.
+//! Understands microsecond and nanosecond captures in either byte order, and the
+//! Ethernet, raw IP, Linux cooked (SLL) and BSD loopback link types.
+static vector<Buffer> load_pcap(const string &filename) {
+    ifstream file{filename, ios::binary};
+    if (not file) {
+        throw runtime_error("cannot open " + filename);
+    }
+    const string contents{istreambuf_iterator<char>(file), istreambuf_iterator<char>()};
+    string_view rest{contents};
+
+    const auto take = [&](const size_t n) {
+        if (rest.size() < n) {
+            throw runtime_error(filename + ": truncated pcap file");
+        }
+        const auto ret = rest.substr(0, n);
+        rest.remove_prefix(n);
+        return ret;
+    };
+
+    const auto global_header = take(24);
+    uint32_t magic{};
+    global_header.copy(reinterpret_cast<char *>(&magic), 4);
+    bool swapped{};
+    switch (magic) {
+        case 0xa1b2c3d4:
+        case 0xa1b23c4d:
+            swapped = false;
+            break;
+        case 0xd4c3b2a1:
+        case 0x4d3cb2a1:
+            swapped = true;
+            break;
+        default:
+            throw runtime_error(filename + ": not a pcap file (pcapng is not supported)");
+    }
+
+    const auto u32_at = [&](string_view bytes, const size_t offset) {
+        uint32_t val{};
+        bytes.copy(reinterpret_cast<char *>(&val), 4, offset);
+        return swapped ? __builtin_bswap32(val) : val;
+    };
+
+    const uint32_t linktype = u32_at(global_header, 20);
+
+    vector<Buffer> packets;
+    while (not rest.empty()) {
+        const auto record_header = take(16);
+        const uint32_t caplen = u32_at(record_header, 8);
+        const uint32_t origlen = u32_at(record_header, 12);
+        auto frame = take(caplen);
+        if (caplen != origlen) {
+            continue;  // the snaplen cut this packet short; it can't be checksummed
+        }
+
+        // strip the link-layer header
+        uint16_t ethertype = 0x0800;
+        switch (linktype) {
+            case 1: {  // Ethernet, possibly with 802.1Q tags
+                if (frame.size() < 14) {
+                    continue;
+                }
+                size_t hdr_len = 14;
+                ethertype = (uint8_t(frame[12]) << 8) | uint8_t(frame[13]);
+                while (ethertype == 0x8100 and frame.size() >= hdr_len + 4) {
+                    ethertype = (uint8_t(frame[hdr_len + 2]) << 8) | uint8_t(frame[hdr_len + 3]);
+                    hdr_len += 4;
+                }
+                frame.remove_prefix(hdr_len);
+            } break;
+            case 0:  // BSD loopback: 4-byte address family in host byte order
+                if (frame.size() < 4) {
+                    continue;
+                }
+                frame.remove_prefix(4);
+                ethertype = (frame.empty() or (uint8_t(frame[0]) >> 4) != 4) ? 0 : 0x0800;
+                break;
+            case 12:
+            case 101:
+            case 228:  // raw IP
+                break;
+            case 113:  // Linux cooked capture
+                if (frame.size() < 16) {
+                    continue;
+                }
+                ethertype = (uint8_t(frame[14]) << 8) | uint8_t(frame[15]);
+                frame.remove_prefix(16);
+                break;
+            default:
+                throw runtime_error(filename + ": unsupported link type " + to_string(linktype));
+        }
+        if (ethertype != 0x0800 or frame.size() < IPv4Header::LENGTH) {
+            continue;
+        }
+
+        // drop link-layer padding past the end of the datagram
+        const size_t ip_len = (uint8_t(frame[2]) << 8) | uint8_t(frame[3]);
+        if (ip_len <= frame.size()) {
+            frame = frame.substr(0, ip_len);
+        }
+        packets.emplace_back(string{frame});
+    }
+
+    return packets;
+}
+
+//! A running stopwatch that charges elapsed time to one Stage at a time
+class StageClock {
+    array<nanoseconds, NumStages> &_totals;
+    steady_clock::time_point _last{steady_clock::now()};
+
+  public:
+    explicit StageClock(array<nanoseconds, NumStages> &totals) : _totals(totals) {}
+
+    //! Charge the time since the previous lap to `stage`
+    void lap(const Stage stage) {
+        const auto now = steady_clock::now();
+        _totals[stage] += now - _last;
+        _last = now;
+    }
+};
+
+//! Push every packet through the receive path once, accumulating into `stats`
+static void replay(const vector<Buffer> &packets,
+                   const size_t capacity,
+                   const bool accept_bad_checksums,
+                   ReplayStats &stats) {
+    map<FlowKey, Flow> flows;
+    StageClock clock{stats.stage_time};
+
+    for (const auto &packet : packets) {
+        // parse: IPv4 header (including its checksum) and TCP header
+        NetParser p{packet};
+        IPv4Header ip{};
+        TCPHeader tcp{};
+        if (ip.parse(p) != ParseResult::NoError or ip.proto != IPv4Header::PROTO_TCP or ip.offset != 0 or ip.mf) {
+            clock.lap(Parse);
+            ++stats.parse_errors;
+            continue;
+        }
+        const Buffer segment = p.buffer();
+        if (tcp.parse(p) != ParseResult::NoError) {
+            clock.lap(Parse);
+            ++stats.parse_errors;
+            continue;
+        }
+        const Buffer payload = p.buffer();
+        clock.lap(Parse);
+
+        // checksum: TCP pseudo-header plus the whole segment
+        InternetChecksum check{ip.pseudo_cksum()};
+        check.add(segment);
+        const bool good_checksum = check.value() == 0;
+        clock.lap(Checksum);
+        if (not good_checksum) {
+            ++stats.bad_checksum;
+            if (not accept_bad_checksums) {
+                continue;
+            }
+        }
+
+        // receive: demultiplex, translate seqno to stream index, reassemble
+        ++stats.segments;
+        stats.payload_bytes += payload.size();
+        const FlowKey key{ip.src, ip.dst, tcp.sport, tcp.dport};
+        auto flow = flows.find(key);
+        if (flow == flows.end()) {
+            flow = flows.emplace(key, Flow{capacity}).first;
+        }
+        Flow &f = flow->second;
+        if (not f.isn.has_value()) {
+            if (not tcp.syn) {
+                clock.lap(Receive);
+                continue;
+            }
+            f.isn = tcp.seqno;
+        }
+        if (not tcp.rst) {
+            const uint64_t checkpoint = f.reassembler.stream_out().bytes_written();
+            const uint64_t abs_seqno = unwrap(tcp.seqno, f.isn.value(), checkpoint);
+            // the SYN occupies absolute seqno 0, so stream index = abs_seqno - 1 for data after it
+            if (tcp.syn or abs_seqno > 0) {
+                const uint64_t stream_index = abs_seqno + (tcp.syn ? 1 : 0) - 1;
+                f.reassembler.push_substring(payload, stream_index, tcp.fin);
+            }
+        }
+        clock.lap(Receive);
+
+        // drain: the application consumes everything that has been reassembled
+        auto &stream = f.reassembler.stream_out();
+        if (not stream.buffer_empty()) {
+            const size_t available = stream.buffer_size();
+            stats.delivered_bytes += stream.read(available).size();
+        }
+        clock.lap(Drain);
+    }
+
+    stats.flows = flows.size();
+}
+
+static void show_usage(const char *argv0) {
+    cerr << "Usage: " << argv0 << " [-n REPS] [-w CAPACITY] [-i] CAPTURE.pcap\n\n"
+         << "   -n REPS      replay the capture REPS times (default: 10)\n"
+         << "   -w CAPACITY  reassembler capacity in bytes per flow (default: " << DEFAULT_CAPACITY << ")\n"
+         << "   -i           deliver segments with bad TCP checksums instead of dropping them\n"
+         << "                (useful for captures taken on hosts with checksum offload)\n";
+}
+
+int main(int argc, char **argv) {
+    try {
+        if (argc <= 0) {
+            abort();
+        }
+
+        unsigned reps = 10;
+        size_t capacity = DEFAULT_CAPACITY;
+        bool accept_bad_checksums = false;
+
+        int opt{};
+        while ((opt = getopt(argc, argv, "n:w:ih")) != -1) {
+            switch (opt) {
+                case 'n':
+                    reps = stoul(optarg);
+                    break;
+                case 'w':
+                    capacity = stoul(optarg);
+                    break;
+                case 'i':
+                    accept_bad_checksums = true;
+                    break;
+                default:
+                    show_usage(argv[0]);
+                    return EXIT_FAILURE;
+            }
+        }
+        if (optind != argc - 1 or reps == 0) {
+            show_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        const auto packets = load_pcap(argv[optind]);
+
+        ReplayStats stats;
+        const auto start = steady_clock::now();
+        for (unsigned rep = 0; rep < reps; ++rep) {
+            replay(packets, capacity, accept_bad_checksums, stats);
+        }
+        const duration<double> wall = steady_clock::now() - start;
+
+        nanoseconds staged{};
+        for (const auto &t : stats.stage_time) {
+            staged += t;
+        }
+
+        const double segs_per_rep = double(stats.segments) / reps;
+        cout << fixed << setprecision(2);
+        cout << "bench_replay: " << packets.size() << " IPv4 packets, " << segs_per_rep << " TCP segments and "
+             << stats.flows << " flows per replay, " << reps << " replays\n";
+        if (stats.bad_checksum) {
+            cout << "  " << stats.bad_checksum / reps << " segments per replay had bad checksums ("
+                 << (accept_bad_checksums ? "delivered" : "dropped; see -i") << ")\n";
+        }
+        if (stats.parse_errors) {
+            cout << "  " << stats.parse_errors / reps << " packets per replay were not parseable TCP\n";
+        }
+        cout << "  wall time:   " << wall.count() * 1000 << " ms\n"
+             << "  segments/s:  " << stats.segments / wall.count() << "\n"
+             << "  payload:     " << stats.payload_bytes * 8 / wall.count() / 1e9 << " Gbit/s ("
+             << stats.payload_bytes / wall.count() << " bytes/s)\n"
+             << "  delivered:   " << stats.delivered_bytes / reps << " bytes per replay\n";
+        for (size_t i = 0; i < NumStages; ++i) {
+            const double ns = stats.stage_time[i].count();
+            cout << "  " << setw(9) << left << STAGE_NAMES[i] << right << setw(10)
+                 << (stats.segments ? ns / stats.segments : 0.0) << " ns/segment  " << setw(6)
+                 << (staged.count() ? 100.0 * ns / staged.count() : 0.0) << "%\n";
+        }
+        bench_report("replay_segments", stats.segments / wall.count(), "segments/s");
+        bench_report("replay_payload", stats.payload_bytes / wall.count(), "bytes/s");
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
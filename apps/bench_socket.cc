@@ -0,0 +1,200 @@
+#include "address.hh"
+#include "bench_util.hh"
+#include "byte_ring.hh"
+#include "packet_channel.hh"
+#include "socket.hh"
+#include "util.hh"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+//! A pair of UDP sockets on the loopback interface, with a receive buffer big enough for a burst
+struct LoopbackPair {
+    UDPSocket sender{};
+    UDPSocket receiver{};
+
+    LoopbackPair() {
+        receiver.bind(Address("127.0.0.1", 0));
+        sender.connect(receiver.local_address());
+    }
+};
+
+//! \brief Send and receive bursts of `burst` datagrams of `size` bytes over loopback
+//! \param[in] batched selects send_batch/recv_batch (two system calls per burst) instead of send/recv
+static void udp_bursts(const size_t burst, const size_t size, const bool batched) {
+    LoopbackPair sockets;
+    const string payload(size, 'x');
+    const Address destination = sockets.receiver.local_address();
+
+    vector<UDPSocket::outgoing_datagram> outgoing(burst, {destination, payload});
+    vector<UDPSocket::received_datagram> incoming(burst, {destination, ""});
+    UDPSocket::received_datagram one{destination, ""};
+
+    const double rate = bench_rate([&] {
+        size_t received = 0;
+        if (batched) {
+            sockets.sender.send_batch(outgoing);
+            while (received < burst) {
+                received += sockets.receiver.recv_batch(incoming, 2048);
+            }
+        } else {
+            for (size_t i = 0; i < burst; ++i) {
+                sockets.sender.send(payload);
+            }
+            for (; received < burst; ++received) {
+                sockets.receiver.recv(one, 2048);
+            }
+        }
+        return received;
+    });
+    bench_report(string("udp_") + (batched ? "batch" : "single") + to_string(burst) + "_" + to_string(size),
+                 rate,
+                 "datagrams/s");
+}
+
+//! Bytes moved from a producer thread to the consumer (the benchmark's thread) per bench_rate call
+static constexpr size_t TRANSFER_SIZE = 1 << 20;
+
+//! \brief Move TRANSFER_SIZE bytes between threads in `chunk`-byte writes through a ByteRing
+//! \details The consumer reads in place with peek() and pop(), as a stack thread would into a ByteStream.
+static void ring_transfer(const size_t chunk) {
+    const string data(chunk, 'x');
+    const double rate = bench_rate([&] {
+        ByteRing ring{65536};
+        thread producer([&] {
+            for (size_t sent = 0; sent < TRANSFER_SIZE; sent += chunk) {
+                ring.write_all(data);
+            }
+            ring.end_input();
+        });
+        size_t received = 0;
+        while (not ring.eof()) {
+            ring.wait_readable();
+            const size_t available = ring.peek().size();
+            received += available;
+            ring.pop(available);
+        }
+        producer.join();
+        return received;
+    });
+    bench_report("byte_ring_transfer_" + to_string(chunk), rate, "bytes/s");
+}
+
+//! Move TRANSFER_SIZE bytes between threads in `chunk`-byte writes through a Unix-domain socket pair
+static void socketpair_transfer(const size_t chunk) {
+    const string data(chunk, 'x');
+    const double rate = bench_rate([&] {
+        int fds[2];
+        SystemCall("socketpair", ::socketpair(AF_UNIX, SOCK_STREAM, 0, static_cast<int *>(fds)));
+        LocalStreamSocket in{FileDescriptor{fds[0]}};
+        LocalStreamSocket out{FileDescriptor{fds[1]}};
+        thread producer([&] {
+            for (size_t sent = 0; sent < TRANSFER_SIZE; sent += chunk) {
+                out.write(data);
+            }
+            out.close();
+        });
+        size_t received = 0;
+        string buffer;
+        while (not in.eof()) {
+            in.read(buffer, 65536);
+            received += buffer.size();
+        }
+        producer.join();
+        return received;
+    });
+    bench_report("socketpair_transfer_" + to_string(chunk), rate, "bytes/s");
+}
+
+//! Packets moved from a producer thread to the consumer per bench_rate call
+static constexpr size_t TRANSFER_PACKETS = 1 << 14;
+
+//! \brief Move TRANSFER_PACKETS packets of `size` bytes between threads through a SharedPacketChannel
+//! \details Both ends are set up as two processes would (the fds pass over a socket pair); the producer
+//! builds each packet in place with reserve() and commit(), and the consumer reads it in place.
+static void packet_channel_transfer(const size_t size) {
+    int fds[2];
+    SystemCall("socketpair", ::socketpair(AF_UNIX, SOCK_STREAM, 0, static_cast<int *>(fds)));
+    LocalStreamSocket here{FileDescriptor{fds[0]}};
+    LocalStreamSocket there{FileDescriptor{fds[1]}};
+    auto sender = SharedPacketChannel::create({256, 2048});
+    sender.send_to(here);
+    auto receiver = SharedPacketChannel::receive_from(there);
+
+    const double rate = bench_rate([&] {
+        thread producer([&] {
+            for (size_t sent = 0; sent < TRANSFER_PACKETS; ++sent) {
+                char *slot = sender.reserve();
+                while (slot == nullptr) {
+                    sender.wait_writable();
+                    slot = sender.reserve();
+                }
+                slot[0] = 'x';
+                sender.commit(size);
+            }
+        });
+        size_t received = 0;
+        while (received < TRANSFER_PACKETS) {
+            receiver.wait_readable();
+            for (auto packet = receiver.front(); packet.has_value(); packet = receiver.front()) {
+                received += packet->size() == size;
+                receiver.pop();
+            }
+        }
+        producer.join();
+        return received;
+    });
+    bench_report("packet_channel_transfer_" + to_string(size), rate, "packets/s");
+}
+
+//! Move TRANSFER_PACKETS packets of `size` bytes between threads through a SOCK_SEQPACKET socket pair
+static void seqpacket_transfer(const size_t size) {
+    int fds[2];
+    SystemCall("socketpair", ::socketpair(AF_UNIX, SOCK_SEQPACKET, 0, static_cast<int *>(fds)));
+    FileDescriptor in{fds[0]};
+    FileDescriptor out{fds[1]};
+    const string packet(size, 'x');
+
+    const double rate = bench_rate([&] {
+        thread producer([&] {
+            for (size_t sent = 0; sent < TRANSFER_PACKETS; ++sent) {
+                out.write(packet);
+            }
+        });
+        size_t received = 0;
+        string buffer;
+        while (received < TRANSFER_PACKETS) {
+            in.read(buffer, 2048);
+            received += buffer.size() == size;
+        }
+        producer.join();
+        return received;
+    });
+    bench_report("seqpacket_transfer_" + to_string(size), rate, "packets/s");
+}
+
+int main() {
+    try {
+        udp_bursts(32, 64, false);
+        udp_bursts(32, 64, true);
+        udp_bursts(32, 1460, false);
+        udp_bursts(32, 1460, true);
+        ring_transfer(16384);
+        socketpair_transfer(16384);
+        packet_channel_transfer(64);
+        seqpacket_transfer(64);
+    } catch (const exception &e) {
+        cerr << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,46 @@
+#ifndef SPONGE_APPS_BENCH_UTIL_HH
+#define SPONGE_APPS_BENCH_UTIL_HH
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+//! \file bench_util.hh
+//! \brief Helpers shared by the bench_* programs
+//! \details Every benchmark reports its results on stdout as lines of the form
+//!
+//!     BENCH <name> <value> <unit>
+//!
+//! where a larger value is always better. `etc/perf_check.py` (run by `make check_perf`) collects
+//! these lines over several runs and compares them against `etc/perf_baseline.json`.
+
+//! Minimum measuring time for each benchmark, in seconds
+static constexpr double BENCH_MIN_SECONDS = 0.25;
+
+//! \brief Measure the rate at which `op` does work
+//! \param[in] op is called repeatedly; each call returns the number of units of work it did
+//! \returns units of work per second, measured over at least BENCH_MIN_SECONDS after one warm-up call
+template <typename Op>
+double bench_rate(Op &&op) {
+    using namespace std::chrono;
+
+    op();  // warm up caches and allocators
+
+    uint64_t units = 0;
+    const auto start = steady_clock::now();
+    duration<double> elapsed{};
+    do {
+        units += op();
+        elapsed = steady_clock::now() - start;
+    } while (elapsed.count() < BENCH_MIN_SECONDS);
+
+    return units / elapsed.count();
+}
+
+//! Print one result in the format understood by etc/perf_check.py
+inline void bench_report(const std::string &name, const double value, const std::string &unit) {
+    std::cout << "BENCH " << name << " " << static_cast<uint64_t>(value) << " " << unit << std::endl;
+}
+
+#endif  // SPONGE_APPS_BENCH_UTIL_HH
@@ -0,0 +1,21 @@
+#include "async.hh"
+
+#include "eventloop.hh"
+#include "file_descriptor.hh"
+#include "util.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <vector>
+
+int main() {
+    try {
+#include "async_example.cc"
+    } catch (...) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
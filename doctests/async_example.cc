@@ -0,0 +1,75 @@
+EventLoop loop;
+AsyncLoop async{loop};
+
+// a Task can co_await another Task and get its result
+auto square = [](const int x) -> Task<int> { co_return x * x; };
+int sum = 0;
+auto add_squares = [](auto &square_of, int &total) -> Task<void> {
+    total += co_await square_of(3);
+    total += co_await square_of(4);
+};
+async.spawn(add_squares(square, sum));
+async.run();
+if (sum != 25) {
+    throw std::runtime_error("awaited Task results");
+}
+
+// sleeping tasks wake up in deadline order, not in the order they were spawned
+std::vector<int> woken;
+auto sleeper = [](AsyncLoop &on, std::vector<int> &log, const int ms) -> Task<void> {
+    co_await on.sleep(std::chrono::milliseconds{ms});
+    log.push_back(ms);
+};
+async.spawn(sleeper(async, woken, 20));
+async.spawn(sleeper(async, woken, 5));
+async.spawn(sleeper(async, woken, 10));
+async.run();
+if (woken != std::vector<int>{5, 10, 20}) {
+    throw std::runtime_error("sleep order");
+}
+
+// a writer and a reader coroutine move more data than the socket buffer holds, each waiting in the
+// EventLoop whenever the non-blocking socket is full or empty
+int fds[2];
+SystemCall("socketpair", ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+FileDescriptor reader_fd{fds[0]}, writer_fd{fds[1]};
+reader_fd.set_blocking(false);
+writer_fd.set_blocking(false);
+
+std::string sent(4 * 1024 * 1024, 0);
+for (size_t i = 0; i < sent.size(); ++i) {
+    sent[i] = static_cast<char>(i * 7);
+}
+std::string received;
+auto writer = [](AsyncLoop &on, FileDescriptor &fd, const std::string &data) -> Task<void> {
+    co_await on.write_all(fd, data);
+    fd.close();
+};
+auto reader = [](AsyncLoop &on, FileDescriptor &fd, std::string &data) -> Task<void> {
+    std::string buffer;
+    while (co_await on.read_some(fd, buffer) > 0) {
+        data += buffer;
+    }
+};
+async.spawn(reader(async, reader_fd, received));
+async.spawn(writer(async, writer_fd, sent));
+async.run();
+if (received != sent) {
+    throw std::runtime_error("data through read_some and write_all");
+}
+
+// an exception that escapes a spawned Task comes out of run()
+auto failing = [](AsyncLoop &on) -> Task<void> {
+    co_await on.sleep(std::chrono::milliseconds{1});
+    throw std::runtime_error("expected");
+};
+async.spawn(failing(async));
+bool threw = false;
+try {
+    async.run();
+} catch (const std::runtime_error &e) {
+    threw = std::string(e.what()) == "expected";
+}
+if (not threw) {
+    throw std::runtime_error("exception from a Task");
+}
@@ -0,0 +1,18 @@
+#include "byte_ring.hh"
+
+#include "eventloop.hh"
+
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+
+int main() {
+    try {
+#include "byte_ring_example.cc"
+    } catch (...) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
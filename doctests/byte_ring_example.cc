@@ -0,0 +1,42 @@
+// the capacity is rounded up to a power of two, and a full ring takes no more
+ByteRing small{3};
+if (small.capacity() != 4 or small.write("abcdef") != 4 or small.write("g") != 0 or small.remaining_capacity() != 0) {
+    throw std::runtime_error("ByteRing capacity");
+}
+if (small.read(2) != "ab" or small.write("efgh") != 2 or small.read(8) != "cdef") {
+    throw std::runtime_error("ByteRing wraparound");
+}
+
+// a producer thread writes more than the ring holds; an EventLoop on this thread drains it through a rule on
+// data_fd() (whose read, in clear_data_ready(), satisfies the loop's busy-wait check)
+ByteRing ring{4096};
+std::string sent(1024 * 1024, 0);
+for (size_t i = 0; i < sent.size(); ++i) {
+    sent[i] = static_cast<char>(i * 13);
+}
+std::thread producer([&] {
+    for (size_t offset = 0; offset < sent.size(); offset += 1000) {
+        ring.write_all(std::string_view{sent}.substr(offset, 1000));
+    }
+    ring.end_input();
+});
+
+EventLoop loop;
+std::string received;
+EventLoop::RuleHandle consumer{};
+consumer = loop.add_rule(ring.data_fd(), Direction::In, [&] {
+    ring.clear_data_ready();
+    for (auto chunk = ring.peek(); not chunk.empty(); chunk = ring.peek()) {
+        received += chunk;
+        ring.pop(chunk.size());
+    }
+    if (ring.eof()) {
+        consumer.cancel();
+    }
+});
+while (loop.wait_next_event(1000) != EventLoop::Result::Exit) {
+}
+producer.join();
+if (received != sent) {
+    throw std::runtime_error("ByteRing through an EventLoop");
+}
@@ -0,0 +1,33 @@
+#include "eventloop.hh"
+
+#include "file_descriptor.hh"
+#include "util.hh"
+
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+int main() {
+    try {
+        {
+#include "eventloop_example_1.cc"
+        } {
+#include "eventloop_example_2.cc"
+        } {
+#include "eventloop_example_3.cc"
+        } {
+#include "eventloop_example_4.cc"
+        } {
+#include "eventloop_example_5.cc"
+        }
+    } catch (...) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,28 @@
+// A callback may run the loop itself, e.g. to wait for the reply to a request it sent. The nested
+// wait_next_event polls with storage of its own, so the outer call's poll results stay intact.
+int request_fds[2];
+int reply_fds[2];
+SystemCall("pipe", ::pipe(request_fds));
+SystemCall("pipe", ::pipe(reply_fds));
+FileDescriptor request_in{request_fds[0]}, request_out{request_fds[1]};
+FileDescriptor reply_in{reply_fds[0]}, reply_out{reply_fds[1]};
+reply_in.set_blocking(false);
+
+EventLoop loop;
+std::string reply;
+unsigned int replies = 0;
+loop.add_rule(request_in, Direction::In, [&] {
+    reply_out.write(request_in.read() + " back");
+    if (loop.wait_next_event(1000) != EventLoop::Result::Success) {
+        throw std::runtime_error("no reply");
+    }
+});
+loop.add_rule(reply_in, Direction::In, [&] {
+    reply = reply_in.read();
+    ++replies;
+});
+
+request_out.write("ping");
+if (loop.wait_next_event(1000) != EventLoop::Result::Success or replies != 1 or reply != "ping back") {
+    throw std::runtime_error("nested wait_next_event went wrong");
+}
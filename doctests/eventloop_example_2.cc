@@ -0,0 +1,53 @@
+// a rule can be paused, resumed, and canceled through the handle that add_rule returns
+int fds[2];
+SystemCall("pipe", ::pipe(fds));
+FileDescriptor in{fds[0]}, out{fds[1]};
+
+EventLoop loop;
+std::string received;
+unsigned int cancels = 0;
+auto rule = loop.add_rule(
+    in, Direction::In, [&] { received += in.read(); }, {}, [&] { ++cancels; });
+
+out.write("a");
+if (loop.wait_next_event(1000) != EventLoop::Result::Success or received != "a") {
+    throw std::runtime_error("active rule");
+}
+
+// a paused rule is not polled: with nothing else to poll, the loop has nothing to do
+rule.pause();
+out.write("b");
+if (not rule.paused() or loop.wait_next_event(0) != EventLoop::Result::Exit or received != "a") {
+    throw std::runtime_error("paused rule");
+}
+
+// once resumed, it picks up what arrived in the meantime
+rule.resume();
+if (rule.paused() or loop.wait_next_event(1000) != EventLoop::Result::Success or received != "ab") {
+    throw std::runtime_error("resumed rule");
+}
+if (rule.stats().wakeups != 2 or rule.stats().callbacks != 2) {
+    throw std::runtime_error("rule stats");
+}
+
+// canceling calls the cancel callback once and invalidates the handle
+rule.cancel();
+rule.cancel();
+if (rule.valid() or cancels != 1 or loop.wait_next_event(0) != EventLoop::Result::Exit) {
+    throw std::runtime_error("canceled rule");
+}
+
+// a callback may cancel its own rule; the node is then reused by the next add_rule
+EventLoop::RuleHandle once{};
+once = loop.add_rule(in, Direction::In, [&] {
+    received += in.read();
+    once.cancel();
+});
+out.write("c");
+if (loop.wait_next_event(1000) != EventLoop::Result::Success or received != "abc" or once.valid()) {
+    throw std::runtime_error("self-canceling rule");
+}
+auto again = loop.add_rule(in, Direction::In, [&] { received += in.read(); });
+if (once.valid() or not again.valid()) {
+    throw std::runtime_error("reused rule node");
+}
@@ -0,0 +1,59 @@
+// with a drain budget, one wakeup serves a burst of datagrams: the callback runs again until the
+// non-blocking fd reports EAGAIN (through try_read, since read throws on EAGAIN) or the budget runs out
+int fds[2];
+SystemCall("socketpair", ::socketpair(AF_UNIX, SOCK_DGRAM, 0, fds));
+FileDescriptor in{fds[0]}, out{fds[1]};
+in.set_blocking(false);
+
+EventLoop loop;
+size_t received = 0;
+std::string datagram;
+auto rule = loop.add_rule(in, Direction::In, [&] {
+    if (in.try_read(datagram, 2048)) {
+        ++received;
+    }
+});
+rule.set_drain_budget(4);
+
+for (int i = 0; i < 10; ++i) {
+    out.write("datagram");
+}
+
+// two wakeups use up the budget, and the third drains the rest and finds the fd empty
+for (const size_t expected : {4, 8, 10}) {
+    if (loop.wait_next_event(1000) != EventLoop::Result::Success or received != expected) {
+        throw std::runtime_error("drain budget");
+    }
+}
+const auto stats = rule.stats();
+if (stats.wakeups != 3 or stats.callbacks != 11 or stats.exhausted != 2 or not in.would_block()) {
+    throw std::runtime_error("drain stats");
+}
+
+// only the reads that succeeded count, and read() itself throws on EAGAIN
+const auto reads = in.read_count();
+if (not in.try_read(datagram, 2048).would_block() or in.read_count() != reads) {
+    throw std::runtime_error("try_read on an empty fd");
+}
+bool threw = false;
+try {
+    in.read(2048);
+} catch (const unix_error &) {
+    threw = true;
+}
+if (not threw) {
+    throw std::runtime_error("read on an empty non-blocking fd");
+}
+
+// a drain budget needs a non-blocking fd
+in.set_blocking(true);
+auto blocking = loop.add_rule(in, Direction::In, [&] { in.read(); });
+threw = false;
+try {
+    blocking.set_drain_budget(2);
+} catch (const std::runtime_error &) {
+    threw = true;
+}
+if (not threw) {
+    throw std::runtime_error("drain budget on a blocking fd");
+}
@@ -0,0 +1,44 @@
+// with busy polling on, wait_next_event spins on non-blocking polls before it sleeps
+int fds[2];
+SystemCall("pipe", ::pipe(fds));
+FileDescriptor in{fds[0]}, out{fds[1]};
+
+EventLoop loop;
+std::string received;
+loop.add_rule(in, Direction::In, [&] { received += in.read(); });
+loop.set_busy_poll(std::chrono::microseconds{100});
+if (loop.busy_poll_stats().spin_budget != std::chrono::microseconds{100}) {
+    throw std::runtime_error("initial spin budget");
+}
+
+// an event that is already waiting is found by the first spin
+out.write("a");
+if (loop.wait_next_event(1000) != EventLoop::Result::Success or received != "a") {
+    throw std::runtime_error("busy poll event");
+}
+if (loop.busy_poll_stats().spins != 1 or loop.busy_poll_stats().spin_wakeups != 1) {
+    throw std::runtime_error("spin wakeup");
+}
+
+// with nothing to find, it spins for the budget and then times out
+if (loop.wait_next_event(5) != EventLoop::Result::Timeout or loop.busy_poll_stats().spin_time.count() == 0) {
+    throw std::runtime_error("busy poll timeout");
+}
+
+// events further apart than the maximum spin turn spinning off
+std::this_thread::sleep_for(std::chrono::milliseconds{5});
+out.write("b");
+if (loop.wait_next_event(1000) != EventLoop::Result::Success or received != "ab") {
+    throw std::runtime_error("second busy poll event");
+}
+if (loop.busy_poll_stats().spin_budget.count() != 0 or loop.busy_poll_stats().interarrival.count() == 0) {
+    throw std::runtime_error("adaptive spin budget");
+}
+
+// turning busy polling off resets the accounting, and waits no longer spin
+loop.set_busy_poll(std::chrono::microseconds{0});
+out.write("c");
+if (loop.wait_next_event(1000) != EventLoop::Result::Success or received != "abc" or
+    loop.busy_poll_stats().spins != 0) {
+    throw std::runtime_error("busy poll off");
+}
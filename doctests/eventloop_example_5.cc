@@ -0,0 +1,50 @@
+// functions posted from another thread run on the loop's thread, in the order they were posted, while
+// the loop waits on an fd that never becomes ready
+int fds[2];
+SystemCall("pipe", ::pipe(fds));
+FileDescriptor idle{fds[0]}, idle_writer{fds[1]};
+
+EventLoop loop;
+loop.add_rule(idle, Direction::In, [&] { idle.read(); });
+
+std::vector<int> ran;
+std::thread poster([&] {
+    for (int i = 0; i < 100; ++i) {
+        loop.post([&ran, i] { ran.push_back(i); });
+    }
+});
+for (int rounds = 0; ran.size() < 100 and rounds < 1000; ++rounds) {
+    loop.wait_next_event(100);
+}
+poster.join();
+for (int i = 0; i < 100; ++i) {
+    if (ran.size() != 100 or ran[i] != i) {
+        throw std::runtime_error("posted functions out of order");
+    }
+}
+
+// a posted function that throws ends that wait; the functions after it run in the next one
+ran.clear();
+loop.post([&] { ran.push_back(1); });
+loop.post([] { throw std::runtime_error("expected"); });
+loop.post([&] { ran.push_back(3); });
+bool threw = false;
+try {
+    loop.wait_next_event(100);
+} catch (const std::runtime_error &) {
+    threw = true;
+}
+if (not threw or ran != std::vector<int>{1}) {
+    throw std::runtime_error("throwing posted function");
+}
+if (loop.wait_next_event(0) != EventLoop::Result::Success or ran != std::vector<int>{1, 3}) {
+    throw std::runtime_error("functions after a throwing posted function");
+}
+
+// a signal given to add_signal_handler arrives through the signalfd and runs its handler on this thread
+int caught = 0;
+loop.add_signal_handler(SIGUSR1, [&](const int signum) { caught = signum; });
+SystemCall("raise", ::raise(SIGUSR1));
+if (loop.wait_next_event(100) != EventLoop::Result::Success or caught != SIGUSR1) {
+    throw std::runtime_error("signal handler");
+}
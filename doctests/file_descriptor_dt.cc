@@ -0,0 +1,28 @@
+#include "file_descriptor.hh"
+
+#include "address.hh"
+#include "buffer.hh"
+#include "byte_stream.hh"
+#include "socket.hh"
+#include "util.hh"
+
+#include <array>
+#include <cerrno>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <sys/uio.h>
+#include <unistd.h>
+
+int main() {
+    try {
+        {
+#include "file_descriptor_example_1.cc"
+        } {
+#include "file_descriptor_example_2.cc"
+        }
+    } catch (...) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
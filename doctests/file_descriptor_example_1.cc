@@ -0,0 +1,46 @@
+// read_into fills caller-owned regions, in order, with one readv
+int fds[2];
+SystemCall("pipe", ::pipe(fds));
+FileDescriptor reader{fds[0]}, writer{fds[1]};
+
+writer.write("hello, world!");
+std::array<char, 5> first{};
+std::array<char, 20> second{};
+const std::array<iovec, 2> regions{{{first.data(), first.size()}, {second.data(), second.size()}}};
+if (reader.read_into(regions.data(), regions.size()) != 13 or std::string(first.data(), 5) != "hello"
+    or std::string(second.data(), 8) != ", world!" or reader.read_count() != 1) {
+    throw std::runtime_error("read_into with caller-owned regions");
+}
+
+// on an empty non-blocking fd, read_into returns 0 without reaching EOF or counting a read
+reader.set_blocking(false);
+if (reader.read_into(regions.data(), regions.size()) != 0 or not reader.would_block() or reader.eof()
+    or reader.read_count() != 1) {
+    throw std::runtime_error("read_into on an empty non-blocking fd");
+}
+reader.set_blocking(true);
+
+// the BufferList version appends one Buffer per region that received data, holding exactly what was read
+writer.write("headpayload");
+BufferList packet;
+if (reader.read_into(packet, {4, 64, 64}) != 11 or packet.buffers().size() != 2
+    or packet.buffers().front().str() != "head" or packet.buffers().back().str() != "payload") {
+    throw std::runtime_error("read_into a BufferList");
+}
+
+// ByteStream::fill_from reads no more than the stream has room for, and ends the input at EOF
+ByteStream stream{8};
+writer.write("0123456789ab");
+if (stream.fill_from(reader) != 8 or stream.remaining_capacity() != 0 or stream.fill_from(reader) != 0) {
+    throw std::runtime_error("fill_from up to capacity");
+}
+if (stream.read(8) != "01234567") {
+    throw std::runtime_error("fill_from data");
+}
+writer.close();
+if (stream.fill_from(reader) != 4 or stream.input_ended() or stream.read(8) != "89ab") {
+    throw std::runtime_error("fill_from the rest");
+}
+if (stream.fill_from(reader) != 0 or not stream.input_ended() or not stream.eof()) {
+    throw std::runtime_error("fill_from at EOF");
+}
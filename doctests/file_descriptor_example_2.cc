@@ -0,0 +1,73 @@
+// an IOResult holds either a byte count or the errno of a failure
+if (not IOResult::success(5) or IOResult::success(5).bytes() != 5 or IOResult::success(0).error() != 0) {
+    throw std::runtime_error("IOResult::success");
+}
+if (IOResult::failure(EAGAIN) or not IOResult::failure(EAGAIN).would_block()
+    or not IOResult::failure(EINTR).interrupted() or IOResult::failure(EINTR).would_block()) {
+    throw std::runtime_error("IOResult::failure");
+}
+bool threw = false;
+try {
+    IOResult::failure(EBADF).throw_error("read");
+} catch (const unix_error &e) {
+    threw = e.code().value() == EBADF;
+}
+if (not threw) {
+    throw std::runtime_error("IOResult::throw_error");
+}
+
+// try_read and try_write report EAGAIN without throwing; only successful calls are counted
+int fds[2];
+SystemCall("pipe", ::pipe(fds));
+FileDescriptor reader{fds[0]}, writer{fds[1]};
+reader.set_blocking(false);
+writer.set_blocking(false);
+
+std::string data{"stale"};
+auto result = reader.try_read(data);
+if (not result.would_block() or not data.empty() or not reader.would_block() or reader.read_count() != 0) {
+    throw std::runtime_error("try_read on an empty pipe");
+}
+
+const std::string chunk(65536, 'x');
+size_t written = 0;
+while ((result = writer.try_write(chunk))) {
+    written += result.bytes();
+}
+const unsigned writes = writer.write_count();
+if (not result.would_block() or not writer.would_block() or written == 0 or writes == 0
+    or writer.try_write(chunk).bytes() != 0 or writer.write_count() != writes) {
+    throw std::runtime_error("try_write on a full pipe");
+}
+
+result = reader.try_read(data, 100);
+if (not result or result.bytes() != 100 or data != std::string(100, 'x') or reader.would_block()
+    or reader.read_count() != 1) {
+    throw std::runtime_error("try_read with data waiting");
+}
+
+// other failures come back as their errno too
+result = writer.try_read(data);
+if (result or result.error() != EBADF or result.would_block()) {
+    throw std::runtime_error("try_read on the write end of a pipe");
+}
+
+// try_recv reports EAGAIN, and a datagram larger than the mtu as EMSGSIZE
+UDPSocket receiver, sender;
+receiver.bind(Address("127.0.0.1", 0));
+sender.bind(Address("127.0.0.1", 0));
+receiver.set_blocking(false);
+UDPSocket::received_datagram datagram{{nullptr, 0}, ""};
+if (not receiver.try_recv(datagram).would_block() or receiver.read_count() != 0) {
+    throw std::runtime_error("try_recv with nothing waiting");
+}
+sender.sendto(receiver.local_address(), std::string{"a datagram"});
+sender.sendto(receiver.local_address(), std::string{"too long for the mtu"});
+result = receiver.try_recv(datagram);
+if (not result or result.bytes() != 10 or datagram.payload != "a datagram"
+    or datagram.source_address != sender.local_address()) {
+    throw std::runtime_error("try_recv");
+}
+if (receiver.try_recv(datagram, 4).error() != EMSGSIZE or receiver.read_count() != 1) {
+    throw std::runtime_error("try_recv of an oversized datagram");
+}
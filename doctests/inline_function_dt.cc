@@ -0,0 +1,31 @@
+#include "inline_function.hh"
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <stdexcept>
+
+//! Allocations so far, to tell inline captures from heap ones
+static size_t allocations = 0;
+
+void *operator new(const size_t size) {
+    ++allocations;
+    if (void *const p = std::malloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+int main() {
+    try {
+#include "inline_function_example.cc"
+    } catch (...) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,46 @@
+// a lambda that captures a couple of references is stored inside the InlineFunction
+int calls = 0;
+const int step = 2;
+size_t before = allocations;
+InlineFunction<int(int)> add{[&calls, &step](const int x) {
+    ++calls;
+    return x + step;
+}};
+if (allocations != before or add(40) != 42 or calls != 1) {
+    throw std::runtime_error("small capture");
+}
+
+// moving it moves the capture along, and leaves the source empty
+InlineFunction<int(int)> moved{std::move(add)};
+if (add or not moved or moved(1) != 3 or allocations != before) {
+    throw std::runtime_error("moved small capture");
+}
+
+// a capture larger than the capacity lives on the heap, and moves by pointer
+std::array<uint64_t, 16> table{};
+table.back() = 7;
+InlineFunction<uint64_t(size_t)> lookup{[table](const size_t i) { return table.at(i); }};
+if (allocations != before + 1 or lookup(15) != 7) {
+    throw std::runtime_error("large capture");
+}
+InlineFunction<uint64_t(size_t)> lookup_moved{std::move(lookup)};
+if (lookup or allocations != before + 1 or lookup_moved(15) != 7) {
+    throw std::runtime_error("moved large capture");
+}
+
+// a move-only capture is moved, never copied, and destroyed once
+auto owner = std::make_shared<int>(5);
+{
+    InlineFunction<int()> get{[p = std::make_unique<std::shared_ptr<int>>(owner)] { return **p; }};
+    InlineFunction<int()> get_moved{std::move(get)};
+    if (get or get_moved() != 5 or owner.use_count() != 2) {
+        throw std::runtime_error("move-only capture");
+    }
+    get_moved = nullptr;
+    if (get_moved or owner.use_count() != 1) {
+        throw std::runtime_error("move-only capture not destroyed");
+    }
+}
+if (owner.use_count() != 1) {
+    throw std::runtime_error("move-only capture destroyed twice");
+}
@@ -0,0 +1,17 @@
+#include "inline_queue.hh"
+
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+int main() {
+    try {
+#include "inline_queue_example.cc"
+    } catch (...) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,70 @@
+// up to Capacity elements live inside the queue object; slots freed by pop_front are reused in place
+auto inside = [](const auto &queue) {
+    const auto *const first = reinterpret_cast<const char *>(&queue.front());
+    return first >= reinterpret_cast<const char *>(&queue) and first < reinterpret_cast<const char *>(&queue + 1);
+};
+InlineQueue<int, 4> small{1, 2, 3, 4};
+small.pop_front();
+small.pop_front();
+small.push_back(5);
+small.push_back(6);
+if (not inside(small) or small.size() != 4 or small.front() != 3 or small.back() != 6 or small[1] != 4) {
+    throw std::runtime_error("inline storage");
+}
+
+// one more element moves them all to the heap, in order
+small.push_back(7);
+if (inside(small) or small.size() != 5 or small[0] != 3 or small[4] != 7) {
+    throw std::runtime_error("growing onto the heap");
+}
+
+// clear keeps the heap block for reuse, and moving a heap queue hands the block over
+const int *const block = &small.front();
+small.clear();
+for (int i = 0; i < 5; ++i) {
+    small.push_back(i);
+}
+InlineQueue<int, 4> moved{std::move(small)};
+if (&moved.front() != block or not small.empty() or moved.size() != 5 or moved[4] != 4) {
+    throw std::runtime_error("clear and move of a heap queue");
+}
+
+// an element of the queue itself can be pushed while the storage grows
+InlineQueue<std::string, 2> strings;
+strings.push_back(std::string(50, 'a'));
+strings.push_back(std::string(50, 'b'));
+strings.push_back(strings.front());
+strings.push_back(strings[1]);
+if (strings.size() != 4 or strings[2] != std::string(50, 'a') or strings[3] != std::string(50, 'b')) {
+    throw std::runtime_error("pushing an element of the queue");
+}
+
+// random operations, including copies and moves, against a std::deque
+std::mt19937 rd{100};
+InlineQueue<std::string, 4> queue;
+std::deque<std::string> expected;
+for (int step = 0; step < 20000; ++step) {
+    const unsigned op = rd() % 10;
+    if (op < 4) {
+        const std::string element(rd() % 40, static_cast<char>('a' + rd() % 26));
+        queue.push_back(element);
+        expected.push_back(element);
+    } else if (op < 7 and not expected.empty()) {
+        queue.pop_front();
+        expected.pop_front();
+    } else if (op == 7) {
+        InlineQueue<std::string, 4> copy{queue};
+        InlineQueue<std::string, 4> taken{std::move(copy)};
+        queue = taken;
+    } else if (op == 8) {
+        InlineQueue<std::string, 4> other{"x"};
+        other = std::move(queue);
+        queue = std::move(other);
+    } else if (rd() % 50 == 0) {
+        queue.clear();
+        expected.clear();
+    }
+    if (queue.size() != expected.size() or not std::equal(queue.begin(), queue.end(), expected.begin())) {
+        throw std::runtime_error("InlineQueue differs from std::deque");
+    }
+}
@@ -0,0 +1,27 @@
+#include "packet_channel.hh"
+
+#include "eventloop.hh"
+#include "file_descriptor.hh"
+#include "socket.hh"
+#include "util.hh"
+
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+int main() {
+    try {
+#include "packet_channel_example.cc"
+    } catch (...) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
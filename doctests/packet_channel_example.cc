@@ -0,0 +1,112 @@
+// the creator passes the channel's fds to a child process, which echoes every packet back
+std::array<int, 2> fds{};
+SystemCall("socketpair", ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds.data()));
+LocalStreamSocket parent_end{FileDescriptor{fds[0]}}, child_end{FileDescriptor{fds[1]}};
+
+auto channel = SharedPacketChannel::create({8, 256});
+channel.send_to(parent_end);
+
+const pid_t child = SystemCall("fork", ::fork());
+if (child == 0) {
+    int status = EXIT_FAILURE;
+    try {
+        auto peer = SharedPacketChannel::receive_from(child_end);
+        for (bool done = false; not done;) {
+            peer.wait_readable();
+            const std::string packet{*peer.front()};
+            peer.pop();
+            while (not peer.send(packet)) {
+                peer.wait_writable();
+            }
+            done = packet == "end";
+        }
+        status = EXIT_SUCCESS;
+    } catch (...) {
+    }
+    ::_exit(status);
+}
+
+// the parent sends from a rule on space_fd() and receives from a rule on data_fd(); each callback's
+// clear_*_ready() reads its doorbell, which satisfies the EventLoop's busy-wait check
+constexpr int PACKETS = 1000;
+int next = 0;
+std::vector<std::string> echoed;
+EventLoop loop;
+auto send_some = [&] {
+    for (; next <= PACKETS; ++next) {
+        if (not channel.send(next < PACKETS ? "packet " + std::to_string(next) : "end")) {
+            break;
+        }
+    }
+};
+loop.add_rule(
+    channel.space_fd(),
+    Direction::In,
+    [&] {
+        channel.clear_space_ready();
+        send_some();
+    },
+    [&] { return next <= PACKETS; });
+EventLoop::RuleHandle receiving{};
+receiving = loop.add_rule(channel.data_fd(), Direction::In, [&] {
+    channel.clear_data_ready();
+    for (auto packet = channel.front(); packet; packet = channel.front()) {
+        echoed.emplace_back(*packet);
+        channel.pop();
+    }
+    if (not echoed.empty() and echoed.back() == "end") {
+        receiving.cancel();
+    }
+});
+
+send_some();
+while (loop.wait_next_event(5000) == EventLoop::Result::Success) {
+}
+
+int status = 0;
+SystemCall("waitpid", ::waitpid(child, &status, 0));
+if (not WIFEXITED(status) or WEXITSTATUS(status) != EXIT_SUCCESS) {
+    throw std::runtime_error("SharedPacketChannel peer process failed");
+}
+if (echoed.size() != PACKETS + 1 or echoed[0] != "packet 0" or echoed[PACKETS - 1] != "packet 999") {
+    throw std::runtime_error("SharedPacketChannel echo");
+}
+
+// a malformed message is rejected without leaking the fds that came with it: neither a wrong tag, nor more
+// fds than a channel has (which sets MSG_CTRUNC)
+auto send_fds = [&](const char tag, const size_t count) {
+    std::vector<int> passed(count, channel.data_fd().fd_num());
+    char byte = tag;
+    iovec iov{&byte, 1};
+    std::vector<char> control(CMSG_SPACE(count * sizeof(int)));
+    msghdr message{};
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control.data();
+    message.msg_controllen = control.size();
+    cmsghdr *cmsg = CMSG_FIRSTHDR(&message);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(count * sizeof(int));
+    memcpy(CMSG_DATA(cmsg), passed.data(), count * sizeof(int));
+    SystemCall("sendmsg", static_cast<int>(::sendmsg(parent_end.fd_num(), &message, 0)));
+};
+auto lowest_free_fd = [] {
+    const int fd = SystemCall("dup", ::dup(STDERR_FILENO));
+    SystemCall("close", ::close(fd));
+    return fd;
+};
+
+const int free_before = lowest_free_fd();
+for (const auto &[tag, count] : {std::pair<char, size_t>{'X', 5}, std::pair<char, size_t>{'P', 6}}) {
+    send_fds(tag, count);
+    bool threw = false;
+    try {
+        SharedPacketChannel::receive_from(child_end);
+    } catch (const std::runtime_error &) {
+        threw = true;
+    }
+    if (not threw or lowest_free_fd() != free_before) {
+        throw std::runtime_error("malformed SharedPacketChannel message");
+    }
+}
@@ -0,0 +1,35 @@
+#include "packet_socket.hh"
+
+#include "buffer.hh"
+#include "eventloop.hh"
+
+#include <cerrno>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+//! Can this process open packet sockets (which need `CAP_NET_RAW`)?
+static bool can_open_packet_sockets() {
+    const int fd = ::socket(AF_PACKET, SOCK_RAW, 0);
+    if (fd < 0) {
+        return errno != EPERM and errno != EACCES;  // other failures should fail the test
+    }
+    ::close(fd);
+    return true;
+}
+
+int main() {
+    if (not can_open_packet_sockets()) {
+        return EXIT_SUCCESS;  // skipped
+    }
+    try {
+#include "packet_socket_example.cc"
+    } catch (...) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
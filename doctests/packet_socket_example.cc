@@ -0,0 +1,41 @@
+// a small ring on the loopback interface, which hands a partly filled block over after 10 ms
+PacketRingSocket sock{"lo", {1 << 16, 4, 4, 2048, 10}};
+
+// with nothing to receive or transmit, neither call counts as I/O
+if (sock.receive([](Buffer) {}) != 0 or sock.read_count() != 0 or not sock.would_block()) {
+    throw std::runtime_error("receive with no block ready");
+}
+sock.flush();
+if (sock.write_count() != 0) {
+    throw std::runtime_error("flush with nothing queued");
+}
+
+// a frame with a local experimental EtherType, sent from the transmit ring
+const std::string payload{"sponge packet ring"};
+std::string frame(12, '\0');
+frame += "\x88\xb5";
+frame += payload;
+if (not sock.send(frame)) {
+    throw std::runtime_error("send into an empty transmit ring");
+}
+sock.flush();
+if (sock.write_count() != 1 or sock.would_block()) {
+    throw std::runtime_error("flush");
+}
+
+// the loopback interface hands the frame back; an EventLoop rule on the socket receives it in place
+EventLoop loop;
+std::vector<Buffer> ours;
+loop.add_rule(sock, Direction::In, [&] {
+    sock.receive([&](Buffer received) {
+        if (received.str().substr(12, 2) == "\x88\xb5") {
+            ours.push_back(std::move(received));
+        }
+    });
+});
+for (int rounds = 0; ours.empty() and rounds < 100; ++rounds) {
+    loop.wait_next_event(100);
+}
+if (ours.empty() or ours.front().str() != frame) {
+    throw std::runtime_error("frame received through the receive ring");
+}
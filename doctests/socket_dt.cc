@@ -1,12 +1,14 @@
 #include "socket.hh"
 
 #include "address.hh"
+#include "buffer.hh"
 #include "util.hh"
 
 #include <array>
 #include <cstdlib>
 #include <random>
 #include <stdexcept>
+#include <string>
 #include <sys/socket.h>
 #include <vector>
 
@@ -18,6 +20,8 @@ int main() {
 #include "socket_example_2.cc"
         } {
 #include "socket_example_3.cc"
+        } {
+#include "socket_example_4.cc"
         }
     } catch (...) {
         return EXIT_FAILURE;
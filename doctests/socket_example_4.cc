@@ -0,0 +1,42 @@
+// send_batch and recv_batch move several datagrams per system call
+UDPSocket receiver, sender;
+receiver.bind(Address("127.0.0.1", 0));
+sender.bind(Address("127.0.0.1", 0));
+receiver.set_blocking(false);
+
+std::vector<UDPSocket::received_datagram> slots(3, UDPSocket::received_datagram{{nullptr, 0}, ""});
+if (receiver.recv_batch(slots, 1500) != 0 or not receiver.would_block() or receiver.read_count() != 0) {
+    throw std::runtime_error("recv_batch with nothing waiting");
+}
+
+// a payload may be made of several pieces, each sent as one datagram
+const Address to = receiver.local_address();
+const std::vector<UDPSocket::outgoing_datagram> outgoing{
+    {to, BufferViewList{"zero"}}, {to, BufferViewList{"one"}}, {to, BufferViewList{"tw", "o"}},
+    {to, BufferViewList{"three"}}, {to, BufferViewList{"four"}}};
+if (sender.send_batch(outgoing) != 5 or sender.write_count() != 1) {
+    throw std::runtime_error("send_batch");
+}
+
+if (receiver.recv_batch(slots, 1500) != 3 or slots[0].payload != "zero" or slots[1].payload != "one"
+    or slots[2].payload != "two" or slots[2].source_address != sender.local_address()
+    or receiver.read_count() != 1) {
+    throw std::runtime_error("recv_batch of a full batch");
+}
+
+// the next batch reuses the slots' storage; slots left over are emptied
+const char *const storage = slots[0].payload.data();
+if (receiver.recv_batch(slots, 1500) != 2 or slots[0].payload != "three" or slots[1].payload != "four"
+    or not slots[2].payload.empty() or slots[0].payload.data() != storage) {
+    throw std::runtime_error("recv_batch of a partial batch");
+}
+
+// a datagram larger than the mtu is marked in its slot, and the datagrams around it are still delivered
+sender.sendto(to, std::string("before"));
+sender.sendto(to, std::string(100, 'x'));
+sender.sendto(to, std::string("after"));
+if (receiver.recv_batch(slots, 10) != 3 or slots[0].payload != "before" or slots[0].truncated
+    or not slots[1].truncated or not slots[1].payload.empty() or slots[2].payload != "after"
+    or slots[2].truncated) {
+    throw std::runtime_error("recv_batch of an oversized datagram");
+}
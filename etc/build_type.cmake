@@ -14,3 +14,5 @@ message (STATUS "    -DCMAKE_BUILD_TYPE=Release   -- full optimizations")
 message (STATUS "    -DCMAKE_BUILD_TYPE=Debug     -- better debugging experience in gdb")
 message (STATUS "    -DCMAKE_BUILD_TYPE=RelASan   -- full optimizations plus address and undefined-behavior sanitizers")
 message (STATUS "    -DCMAKE_BUILD_TYPE=DebugASan -- debug plus sanitizers")
+message (STATUS "    -DCMAKE_BUILD_TYPE=ReleaseLTO -- full optimizations plus link-time optimization")
+message (STATUS "    -DCMAKE_BUILD_TYPE=ReleasePGO -- ReleaseLTO plus profile-guided optimization (two phases, see readme)")
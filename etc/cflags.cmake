@@ -14,7 +14,73 @@ if (${IS_CLANG_COMPILER})
     set (CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -Wloop-analysis")
 endif ()
 
+# C++20 coroutines: libsponge/util/async.hh is only used by targets that set CXX_STANDARD 20
+include (CheckCXXSourceCompiles)
+set (CMAKE_REQUIRED_FLAGS "-std=c++20")
+check_cxx_source_compiles ("#include <coroutine>
+int main() { return std::noop_coroutine().done() ? 1 : 0; }" SPONGE_HAVE_COROUTINES)
+unset (CMAKE_REQUIRED_FLAGS)
+
 # add some flags for the Release, Debug, and DebugSan modes
 set (CMAKE_CXX_FLAGS_DEBUG "${CMAKE_CXX_FLAGS_DEBUG} -ggdb3 -Og")
 set (CMAKE_CXX_FLAGS_DEBUGASAN "${CMAKE_CXX_FLAGS_DEBUG} -fsanitize=undefined -fsanitize=address")
 set (CMAKE_CXX_FLAGS_RELASAN "${CMAKE_CXX_FLAGS_RELEASE} -fsanitize=undefined -fsanitize=address")
+
+# coverage-guided fuzzing with libFuzzer (clang only): instrument all code, and link the fuzz/ targets
+# with the libFuzzer driver instead of fuzz/fuzz_standalone.cc
+option (SPONGE_LIBFUZZER "build the fuzz targets with libFuzzer (-fsanitize=fuzzer); requires clang" OFF)
+if (SPONGE_LIBFUZZER)
+    if (NOT ${IS_CLANG_COMPILER})
+        message (FATAL_ERROR "SPONGE_LIBFUZZER requires clang (e.g., CXX=clang++ cmake ..).")
+    endif ()
+    set (CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -fsanitize=fuzzer-no-link")
+endif ()
+
+# link-time optimization for ReleaseLTO and ReleasePGO
+if (${IS_GNU_COMPILER} AND NOT ("${CMAKE_CXX_COMPILER_VERSION}" VERSION_LESS 10))
+    set (SPONGE_LTO_FLAGS "-flto=auto")
+else ()
+    set (SPONGE_LTO_FLAGS "-flto")
+endif ()
+set (CMAKE_CXX_FLAGS_RELEASELTO "${CMAKE_CXX_FLAGS_RELEASE} ${SPONGE_LTO_FLAGS}")
+set (CMAKE_EXE_LINKER_FLAGS_RELEASELTO "${CMAKE_EXE_LINKER_FLAGS_RELEASE} ${SPONGE_LTO_FLAGS}")
+
+# profile-guided optimization: build with SPONGE_PGO_PHASE=generate, run `make pgo_train`, then
+# reconfigure with SPONGE_PGO_PHASE=use and rebuild
+set (SPONGE_PGO_PHASE "generate" CACHE STRING "ReleasePGO phase: generate (instrumented build) or use (optimize with the recorded profile)")
+set (SPONGE_PGO_DIR "${PROJECT_BINARY_DIR}/pgo" CACHE PATH "directory holding the ReleasePGO profile")
+if ("${SPONGE_PGO_PHASE}" STREQUAL "generate")
+    set (SPONGE_PGO_FLAGS "-fprofile-generate=${SPONGE_PGO_DIR}")
+elseif ("${SPONGE_PGO_PHASE}" STREQUAL "use")
+    if (${IS_CLANG_COMPILER})
+        set (SPONGE_PGO_FLAGS "-fprofile-use=${SPONGE_PGO_DIR}/sponge.profdata -Wno-profile-instr-unprofiled -Wno-profile-instr-out-of-date")
+    else ()
+        # code the benchmarks never reach (e.g., webget) has no profile; stale profiles are not fatal
+        set (SPONGE_PGO_FLAGS "-fprofile-use=${SPONGE_PGO_DIR} -fprofile-correction -Wno-error=coverage-mismatch")
+        if (NOT ("${CMAKE_CXX_COMPILER_VERSION}" VERSION_LESS 9))
+            set (SPONGE_PGO_FLAGS "${SPONGE_PGO_FLAGS} -Wno-missing-profile")
+        endif ()
+        if (NOT ("${CMAKE_CXX_COMPILER_VERSION}" VERSION_LESS 10))
+            set (SPONGE_PGO_FLAGS "${SPONGE_PGO_FLAGS} -fprofile-partial-training")
+        endif ()
+    endif ()
+else ()
+    message (FATAL_ERROR "SPONGE_PGO_PHASE must be 'generate' or 'use', not '${SPONGE_PGO_PHASE}'.")
+endif ()
+set (CMAKE_CXX_FLAGS_RELEASEPGO "${CMAKE_CXX_FLAGS_RELEASELTO} ${SPONGE_PGO_FLAGS}")
+set (CMAKE_EXE_LINKER_FLAGS_RELEASEPGO "${CMAKE_EXE_LINKER_FLAGS_RELEASELTO} ${SPONGE_PGO_FLAGS}")
+
+# libsponge is a static library, so LTO objects must be archived with the plugin-aware ar
+if (("${CMAKE_BUILD_TYPE}" STREQUAL "ReleaseLTO") OR ("${CMAKE_BUILD_TYPE}" STREQUAL "ReleasePGO"))
+    if (${IS_CLANG_COMPILER})
+        find_program (SPONGE_LTO_AR NAMES llvm-ar)
+        find_program (SPONGE_LTO_RANLIB NAMES llvm-ranlib)
+    else ()
+        find_program (SPONGE_LTO_AR NAMES gcc-ar)
+        find_program (SPONGE_LTO_RANLIB NAMES gcc-ranlib)
+    endif ()
+    if (SPONGE_LTO_AR AND SPONGE_LTO_RANLIB)
+        set (CMAKE_AR "${SPONGE_LTO_AR}")
+        set (CMAKE_RANLIB "${SPONGE_LTO_RANLIB}")
+    endif ()
+endif ()
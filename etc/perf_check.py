@@ -0,0 +1,193 @@
+#!/usr/bin/env python3
+"""Run the bench_* programs several times and compare their results with a stored baseline.
+
+Each benchmark prints lines of the form `BENCH <name> <value> <unit>` (larger is better; see
+apps/bench_util.hh). For every metric this script takes the median over --runs runs, together with
+a distribution-free confidence interval for that median, and reports a regression when even the
+upper end of the interval falls more than --threshold below the baseline median. Noise from a
+single slow run therefore cannot fail the gate, but a consistent slowdown does. The interval only
+excludes the fastest and slowest runs from 9 runs on (the default); with fewer runs, it is the
+whole range of the samples, and the gate only catches slowdowns that affect every run.
+
+    perf_check.py --baseline etc/perf_baseline.json BENCH...            # compare (make check_perf)
+    perf_check.py --baseline etc/perf_baseline.json --update BENCH...   # record a new baseline
+    perf_check.py --reference-build ../build-release BENCH...           # speedup vs. another build
+
+With --reference-build, each benchmark is also run from the apps/ directory of the given build tree
+(normally a plain Release build), alternating with the benchmark under test so that drift in machine
+load affects both equally, and the ratio of medians is reported for every metric along with their
+geometric mean (make perf_speedup, e.g. from a ReleaseLTO or ReleasePGO build).
+"""
+
+import argparse
+import json
+import math
+import os
+import subprocess
+import sys
+
+
+def run_once(command):
+    """Run one benchmark command and return {metric: (value, unit)}."""
+    output = subprocess.run(command, check=True, stdout=subprocess.PIPE, universal_newlines=True).stdout
+    results = {}
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) == 4 and fields[0] == "BENCH":
+            results[fields[1]] = (float(fields[2]), fields[3])
+    return results
+
+
+def collect(commands, runs, split=False):
+    """Run every command `runs` times; return {metric: {"samples": [...], "unit": str}}.
+
+    With `split`, the commands alternate between two builds (even positions, odd positions) and a
+    pair of such dicts is returned, one per build.
+    """
+    metrics = ({}, {}) if split else ({},)
+    for run in range(runs):
+        for position, command in enumerate(commands):
+            print("  [run {}/{}] {}".format(run + 1, runs, command[0]), file=sys.stderr)
+            target = metrics[position % 2] if split else metrics[0]
+            for name, (value, unit) in run_once(command).items():
+                target.setdefault(name, {"samples": [], "unit": unit})["samples"].append(value)
+    return metrics if split else metrics[0]
+
+
+def median(samples):
+    ordered = sorted(samples)
+    mid = len(ordered) // 2
+    return ordered[mid] if len(ordered) % 2 else (ordered[mid - 1] + ordered[mid]) / 2
+
+
+def median_interval(samples, confidence=0.95):
+    """Distribution-free confidence interval for the median, from order statistics.
+
+    Picks the widest k such that P(Binomial(n, 1/2) < k) <= (1 - confidence) / 2 and returns
+    (x_(k), x_(n-k+1)). With too few samples for the requested confidence (fewer than 9 at 95%),
+    k is 1 and the interval is just (min, max).
+    """
+    ordered = sorted(samples)
+    n = len(ordered)
+    alpha = (1 - confidence) / 2
+    k, tail = 0, 0.0
+    while True:
+        next_tail = tail + math.comb(n, k) / 2 ** n
+        if next_tail > alpha:
+            break
+        tail = next_tail
+        k += 1
+    k = max(k, 1)
+    return ordered[k - 1], ordered[n - k]
+
+
+def summarize(metrics):
+    summary = {}
+    for name, data in sorted(metrics.items()):
+        low, high = median_interval(data["samples"])
+        summary[name] = {"median": median(data["samples"]), "ci_low": low, "ci_high": high, "unit": data["unit"]}
+    return summary
+
+
+def compare(summary, baseline, threshold):
+    """Print a comparison table; return the number of regressions."""
+    regressions = 0
+    print("{:<36} {:>16} {:>16} {:>8}  {}".format("metric", "baseline", "median", "change", "status"))
+    for name, base in sorted(baseline["metrics"].items()):
+        if name not in summary:
+            print("{:<36} {:>16.0f} {:>16} {:>8}  MISSING".format(name, base["median"], "-", "-"))
+            regressions += 1
+            continue
+        cur = summary[name]
+        change = cur["median"] / base["median"] - 1
+        floor = base["median"] * (1 - threshold)
+        if cur["ci_high"] < floor:
+            status = "REGRESSION"
+            regressions += 1
+        elif cur["ci_low"] > base["median"] * (1 + threshold):
+            status = "improved (consider --update)"
+        else:
+            status = "ok"
+        print("{:<36} {:>16.0f} {:>16.0f} {:>+7.1f}%  {}".format(name, base["median"], cur["median"], 100 * change,
+                                                                 status))
+    for name in sorted(set(summary) - set(baseline["metrics"])):
+        print("{:<36} {:>16} {:>16.0f} {:>8}  new (not in baseline)".format(name, "-", summary[name]["median"], "-"))
+    return regressions
+
+
+def speedup(summary, reference):
+    """Print the speedup of `summary` over `reference` for each metric; return the geometric mean."""
+    log_sum, count = 0.0, 0
+    print("{:<36} {:>16} {:>16} {:>8}".format("metric", "reference", "median", "speedup"))
+    for name, ref in sorted(reference.items()):
+        if name not in summary:
+            continue
+        ratio = summary[name]["median"] / ref["median"]
+        log_sum += math.log(ratio)
+        count += 1
+        print("{:<36} {:>16.0f} {:>16.0f} {:>7.3f}x".format(name, ref["median"], summary[name]["median"], ratio))
+    if count == 0:
+        raise SystemExit("perf_check.py: no metrics in common with the reference build")
+    return math.exp(log_sum / count)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--baseline", help="baseline JSON file")
+    parser.add_argument("--reference-build", metavar="DIR",
+                        help="report speedup over the same benchmarks in build tree DIR instead of checking a baseline")
+    parser.add_argument("--runs", type=int, default=9,
+                        help="runs of each benchmark (default: 9, the fewest for which the 95%% interval "
+                             "of the median is narrower than the range of the samples)")
+    parser.add_argument("--threshold", type=float, default=0.15,
+                        help="tolerated slowdown as a fraction of the baseline median (default: 0.15)")
+    parser.add_argument("--update", action="store_true", help="write the measured medians to --baseline")
+    parser.add_argument("benchmarks", nargs="+", help="benchmark executables")
+    args = parser.parse_args()
+
+    if args.runs < 1:
+        parser.error("--runs must be positive")
+    if (args.baseline is None) == (args.reference_build is None):
+        parser.error("exactly one of --baseline and --reference-build is required")
+
+    print("Running benchmarks ({} runs each)...".format(args.runs), file=sys.stderr)
+    if args.baseline is not None and not args.update and median_interval(range(args.runs)) == (0, args.runs - 1):
+        print("note: with {} runs the confidence interval is the sample range (min/max gate)".format(args.runs),
+              file=sys.stderr)
+
+    if args.reference_build is not None:
+        references = [os.path.join(args.reference_build, "apps", os.path.basename(bench)) for bench in args.benchmarks]
+        for reference in references:
+            if not os.access(reference, os.X_OK):
+                parser.error("no benchmark {} (build the reference tree first)".format(reference))
+        interleaved = collect([cmd for pair in zip(args.benchmarks, references) for cmd in ([pair[0]], [pair[1]])],
+                              args.runs, split=True)
+        geomean = speedup(summarize(interleaved[0]), summarize(interleaved[1]))
+        print("\nGeometric mean speedup over {}: {:.3f}x".format(args.reference_build, geomean))
+        return 0
+
+    summary = summarize(collect([[bench] for bench in args.benchmarks], args.runs))
+
+    if args.update:
+        with open(args.baseline, "w") as f:
+            json.dump({"runs": args.runs,
+                       "metrics": {name: {"median": round(m["median"]), "unit": m["unit"]}
+                                   for name, m in summary.items()}},
+                      f, indent=2, sort_keys=True)
+            f.write("\n")
+        print("Wrote baseline for {} metrics to {}".format(len(summary), args.baseline))
+        return 0
+
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+    regressions = compare(summary, baseline, args.threshold)
+    if regressions:
+        print("\n{} metric(s) regressed by more than {:.0f}% with {:.0f}% confidence.".format(
+            regressions, 100 * args.threshold, 95))
+        return 1
+    print("\nNo throughput regressions beyond {:.0f}%.".format(100 * args.threshold))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
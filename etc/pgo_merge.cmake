@@ -0,0 +1,14 @@
+# Merge the raw clang profiles written by a ReleasePGO "generate" build into ${PGO_DIR}/sponge.profdata.
+# Usage: cmake -DLLVM_PROFDATA=<path> -DPGO_DIR=<dir> -P pgo_merge.cmake
+if (NOT LLVM_PROFDATA)
+    message (FATAL_ERROR "llvm-profdata is required to merge clang PGO profiles.")
+endif ()
+file (GLOB PROFRAW_FILES "${PGO_DIR}/*.profraw")
+if (NOT PROFRAW_FILES)
+    message (FATAL_ERROR "No .profraw files in ${PGO_DIR}; did the benchmarks run?")
+endif ()
+execute_process (COMMAND "${LLVM_PROFDATA}" merge -o "${PGO_DIR}/sponge.profdata" ${PROFRAW_FILES}
+                 RESULT_VARIABLE MERGE_RESULT)
+if (NOT MERGE_RESULT EQUAL 0)
+    message (FATAL_ERROR "llvm-profdata merge failed.")
+endif ()
@@ -30,12 +30,18 @@ add_test(NAME t_strm_reassem_many        COMMAND fsm_stream_reassembler_many)
 add_test(NAME t_strm_reassem_overlapping COMMAND fsm_stream_reassembler_overlapping)
 add_test(NAME t_strm_reassem_win         COMMAND fsm_stream_reassembler_win)
 add_test(NAME t_strm_reassem_cap         COMMAND fsm_stream_reassembler_cap)
+add_test(NAME t_strm_reassem_buffer      COMMAND fsm_stream_reassembler_buffer)
+add_test(NAME t_strm_reassem_small       COMMAND fsm_stream_reassembler_small)
+add_test(NAME t_strm_reassem_batch       COMMAND fsm_stream_reassembler_batch)
 
 add_test(NAME t_byte_stream_construction COMMAND byte_stream_construction)
 add_test(NAME t_byte_stream_one_write    COMMAND byte_stream_one_write)
 add_test(NAME t_byte_stream_two_writes   COMMAND byte_stream_two_writes)
 add_test(NAME t_byte_stream_capacity     COMMAND byte_stream_capacity)
 add_test(NAME t_byte_stream_many_writes  COMMAND byte_stream_many_writes)
+add_test(NAME t_byte_stream_chunks       COMMAND byte_stream_chunks)
+add_test(NAME t_byte_stream_gather       COMMAND byte_stream_gather)
+add_test(NAME t_memory_accountant        COMMAND memory_accountant)
 
 add_test(NAME t_webget               COMMAND "${PROJECT_SOURCE_DIR}/tests/webget_t.sh")
 
@@ -62,10 +68,32 @@ add_test(NAME t_retx_win             COMMAND fsm_retx_win)
 add_test(NAME t_loopback             COMMAND fsm_loopback)
 add_test(NAME t_loopback_win         COMMAND fsm_loopback_win)
 add_test(NAME t_reorder              COMMAND fsm_reorder)
+if (TARGET fsm_in_memory_soak)
+    add_test(NAME t_fsm_in_memory_soak COMMAND fsm_in_memory_soak)
+endif ()
 
 add_test(NAME t_address_dt           COMMAND address_dt)
 add_test(NAME t_parser_dt            COMMAND parser_dt)
 add_test(NAME t_socket_dt            COMMAND socket_dt)
+add_test(NAME t_eventloop_dt         COMMAND eventloop_dt)
+add_test(NAME t_inline_function_dt   COMMAND inline_function_dt)
+add_test(NAME t_inline_queue_dt      COMMAND inline_queue_dt)
+add_test(NAME t_file_descriptor_dt   COMMAND file_descriptor_dt)
+add_test(NAME t_byte_ring_dt         COMMAND byte_ring_dt)
+add_test(NAME t_packet_channel_dt    COMMAND packet_channel_dt)
+add_test(NAME t_packet_socket_dt     COMMAND packet_socket_dt)
+if (TARGET async_dt)
+    add_test(NAME t_async_dt         COMMAND async_dt)
+endif ()
+
+add_test(NAME t_fuzz_ipv4_header     COMMAND fuzz_ipv4_header -runs=2000 -seed=1)
+add_test(NAME t_fuzz_tcp_header      COMMAND fuzz_tcp_header -runs=2000 -seed=1)
+add_test(NAME t_fuzz_ethernet_header COMMAND fuzz_ethernet_header -runs=2000 -seed=1)
+add_test(NAME t_fuzz_arp_message     COMMAND fuzz_arp_message -runs=2000 -seed=1)
+add_test(NAME t_fuzz_reassembler     COMMAND fuzz_reassembler -runs=2000 -seed=1)
+# Only the allocation limits are deterministic; time limits are for real fuzzing runs
+set_tests_properties(t_fuzz_ipv4_header t_fuzz_tcp_header t_fuzz_ethernet_header t_fuzz_arp_message
+                     t_fuzz_reassembler PROPERTIES ENVIRONMENT SPONGE_FUZZ_NO_TIME_LIMIT=1)
 
 add_test(NAME t_udp_client_send      COMMAND "${PROJECT_SOURCE_DIR}/txrx.sh" -ucS)
 add_test(NAME t_udp_server_send      COMMAND "${PROJECT_SOURCE_DIR}/txrx.sh" -usS)
@@ -236,3 +264,39 @@ add_custom_target (check COMMAND "${PROJECT_SOURCE_DIR}/tun.sh" check 144 145
                          COMMAND "${PROJECT_SOURCE_DIR}/tap.sh" check 10
                          COMMAND ${CMAKE_CTEST_COMMAND} --output-on-failure --timeout 10 -R '^t_|^arp_|^router_'
                          COMMENT "Testing libsponge...")
+
+set (PERF_BENCHMARKS bench_byte_stream bench_reassembler bench_parser bench_eventloop bench_socket)
+set (PERF_BENCHMARK_PATHS "")
+foreach (bench ${PERF_BENCHMARKS})
+    list (APPEND PERF_BENCHMARK_PATHS "$<TARGET_FILE:${bench}>")
+endforeach (bench)
+
+add_custom_target (check_perf COMMAND "${PROJECT_SOURCE_DIR}/etc/perf_check.py"
+                                      --baseline "${PROJECT_SOURCE_DIR}/etc/perf_baseline.json" ${PERF_BENCHMARK_PATHS}
+                              COMMENT "Comparing benchmark throughput against the stored baseline...")
+add_custom_target (perf_baseline COMMAND "${PROJECT_SOURCE_DIR}/etc/perf_check.py" --update
+                                         --baseline "${PROJECT_SOURCE_DIR}/etc/perf_baseline.json" ${PERF_BENCHMARK_PATHS}
+                                 COMMENT "Recording a new benchmark baseline...")
+add_dependencies (check_perf ${PERF_BENCHMARKS})
+add_dependencies (perf_baseline ${PERF_BENCHMARKS})
+
+if ("${CMAKE_BUILD_TYPE}" STREQUAL "ReleasePGO" AND "${SPONGE_PGO_PHASE}" STREQUAL "generate")
+    set (PGO_TRAIN_COMMANDS COMMAND ${CMAKE_COMMAND} -E remove_directory "${SPONGE_PGO_DIR}")
+    foreach (bench ${PERF_BENCHMARK_PATHS})
+        list (APPEND PGO_TRAIN_COMMANDS COMMAND "${bench}")
+    endforeach (bench)
+    if (${IS_CLANG_COMPILER})
+        find_program (LLVM_PROFDATA NAMES llvm-profdata)
+        list (APPEND PGO_TRAIN_COMMANDS COMMAND ${CMAKE_COMMAND} -DLLVM_PROFDATA=${LLVM_PROFDATA}
+                                                -DPGO_DIR=${SPONGE_PGO_DIR} -P "${PROJECT_SOURCE_DIR}/etc/pgo_merge.cmake")
+    endif ()
+    add_custom_target (pgo_train ${PGO_TRAIN_COMMANDS}
+                                 COMMENT "Recording a PGO profile from the benchmarks; next, re-run cmake with -DSPONGE_PGO_PHASE=use")
+    add_dependencies (pgo_train ${PERF_BENCHMARKS})
+endif ()
+
+set (SPONGE_REFERENCE_BUILD "" CACHE PATH "plain Release build directory that perf_speedup compares against")
+add_custom_target (perf_speedup COMMAND "${PROJECT_SOURCE_DIR}/etc/perf_check.py"
+                                        --reference-build "${SPONGE_REFERENCE_BUILD}" ${PERF_BENCHMARK_PATHS}
+                                COMMENT "Comparing benchmark throughput against the reference build...")
+add_dependencies (perf_speedup ${PERF_BENCHMARKS})
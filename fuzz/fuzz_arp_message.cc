@@ -0,0 +1,36 @@
+#include "arp_message.hh"
+#include "fuzz_util.hh"
+#include "parser.hh"
+
+#include <string>
+
+using namespace std;
+
+static const string TARGET = "fuzz_arp_message";
+
+//! Parsing copies the input once; serializing and printing allocate a bounded amount
+static constexpr FuzzBudget::Limits LIMITS{20, 1, 256, 0, 16384, 4};
+
+//! \details If the input parses, it must be a supported message and serialize back to the first
+//! ARPMessage::LENGTH bytes of the input.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    const FuzzBudget budget{TARGET, size, LIMITS};
+
+    const string input{reinterpret_cast<const char *>(data), size};
+    ARPMessage arp{};
+    const ParseResult result = arp.parse(Buffer{string{input}});
+    as_string(result);
+    arp.to_string();
+
+    if (result == ParseResult::NoError) {
+        if (not arp.supported()) {
+            fuzz_fail(TARGET, "parsed an unsupported message: " + arp.to_string());
+        }
+        if (arp.serialize() != input.substr(0, ARPMessage::LENGTH)) {
+            fuzz_fail(TARGET, "serialized message differs from the input: " + arp.to_string());
+        }
+    }
+
+    budget.check();
+    return 0;
+}
@@ -0,0 +1,39 @@
+#include "ethernet_header.hh"
+#include "fuzz_util.hh"
+#include "parser.hh"
+
+#include <string>
+
+using namespace std;
+
+static const string TARGET = "fuzz_ethernet_header";
+
+//! Parsing copies the input once; serializing and printing allocate a bounded amount
+static constexpr FuzzBudget::Limits LIMITS{20, 1, 256, 0, 16384, 4};
+
+//! \details If the input parses, the header must consume exactly EthernetHeader::LENGTH bytes and
+//! serialize back to them.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    const FuzzBudget budget{TARGET, size, LIMITS};
+
+    const string input{reinterpret_cast<const char *>(data), size};
+    const Buffer frame{string{input}};
+    NetParser p{frame};
+    EthernetHeader h{};
+    const ParseResult result = h.parse(p);
+    as_string(result);
+
+    if (result == ParseResult::NoError) {
+        if (p.buffer().size() != size - EthernetHeader::LENGTH) {
+            fuzz_fail(TARGET, "parsed header did not consume its length: " + h.to_string());
+        }
+        if (h.serialize() != input.substr(0, EthernetHeader::LENGTH)) {
+            fuzz_fail(TARGET, "serialized header differs from the input: " + h.to_string());
+        }
+    } else if (size >= EthernetHeader::LENGTH) {
+        fuzz_fail(TARGET, "a frame with a complete header failed to parse: " + as_string(result));
+    }
+
+    budget.check();
+    return 0;
+}
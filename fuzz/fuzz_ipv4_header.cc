@@ -0,0 +1,73 @@
+#include "fuzz_util.hh"
+#include "ipv4_header.hh"
+#include "parser.hh"
+#include "util.hh"
+
+#include <algorithm>
+#include <string>
+
+using namespace std;
+
+static const string TARGET = "fuzz_ipv4_header";
+
+//! Parsing copies the input once; serializing and printing allocate a bounded amount
+static constexpr FuzzBudget::Limits LIMITS{20, 1, 256, 0, 16384, 8};
+
+//! Parse `datagram`; if it parses, check the result and that re-serializing the header round-trips
+static void parse_and_check(string datagram) {
+    const size_t size = datagram.size();
+    const Buffer buffer{move(datagram)};
+    NetParser p{buffer};
+    IPv4Header h{};
+    const ParseResult result = h.parse(p);
+    as_string(result);
+    if (result != ParseResult::NoError) {
+        return;
+    }
+
+    if (h.hlen < 5 or h.len != size or p.buffer().size() != h.payload_length()) {
+        fuzz_fail(TARGET, "parsed header is inconsistent with the datagram: " + h.to_string());
+    }
+    h.summary();
+
+    // options and reserved bits are not kept, so re-serialize with a recomputed checksum
+    IPv4Header fixed{h};
+    fixed.cksum = 0;
+    InternetChecksum check;
+    check.add(fixed.serialize());
+    fixed.cksum = check.value();
+
+    const Buffer again{fixed.serialize() + p.buffer().copy()};
+    NetParser q{again};
+    IPv4Header h2{};
+    if (h2.parse(q) != ParseResult::NoError or h2.serialize() != fixed.serialize()) {
+        fuzz_fail(TARGET, "serialized header does not parse back to the same header: " + h.to_string());
+    }
+}
+
+//! \details Besides the raw input, also tries a copy whose version, length, and checksum fields are
+//! fixed up, so that random and mutated inputs reach the code past those checks.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    const FuzzBudget budget{TARGET, size, LIMITS};
+
+    string datagram{reinterpret_cast<const char *>(data), size};
+    parse_and_check(datagram);
+
+    if (size >= IPv4Header::LENGTH and size <= UINT16_MAX) {
+        const uint8_t hlen = max<uint8_t>(5, datagram[0] & 0xf);
+        if (size >= 4 * hlen) {
+            datagram[0] = static_cast<char>(0x40 | hlen);
+            datagram[2] = static_cast<char>(size >> 8);
+            datagram[3] = static_cast<char>(size & 0xff);
+            datagram[10] = datagram[11] = 0;
+            InternetChecksum check;
+            check.add({datagram.data(), 4 * size_t{hlen}});
+            datagram[10] = static_cast<char>(check.value() >> 8);
+            datagram[11] = static_cast<char>(check.value() & 0xff);
+            parse_and_check(move(datagram));
+        }
+    }
+
+    budget.check();
+    return 0;
+}
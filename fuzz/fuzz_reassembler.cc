@@ -0,0 +1,153 @@
+#include "fuzz_util.hh"
+#include "stream_reassembler.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static const string TARGET = "fuzz_reassembler";
+
+//! \details Each operation (3-4 input bytes) may push up to 255 bytes, which are copied a few times
+//! on their way to the output; anything that grows faster than that with the number of operations
+//! (e.g., re-copying everything buffered on every push or read) exceeds the budget.
+static constexpr FuzzBudget::Limits LIMITS{50, 20, 512, 4, 65536, 512};
+
+//! Byte at index `i` of the stream (so that overlapping substrings always agree, as they do in TCP)
+static char stream_byte(const uint64_t i) { return static_cast<char>('a' + i % 23); }
+
+//! Sequential reader of the fuzzer's input; reads past the end yield zero
+class Input {
+    const uint8_t *_data;
+    size_t _size;
+
+  public:
+    Input(const uint8_t *data, const size_t size) : _data(data), _size(size) {}
+    Input(const Input &other) = default;
+    Input &operator=(const Input &other) = default;
+
+    bool empty() const { return _size == 0; }
+
+    uint8_t u8() {
+        if (_size == 0) {
+            return 0;
+        }
+        --_size;
+        return *_data++;
+    }
+
+    uint16_t u16() { return static_cast<uint16_t>((u8() << 8) | u8()); }
+};
+
+//! \brief Obviously-correct StreamReassembler: one flag per byte of the window
+//! \details Keeps the bytes in [first unassembled, first unread + capacity), like StreamReassembler,
+//! and assembles one byte at a time.
+class ReferenceReassembler {
+    size_t _capacity;
+    vector<bool> _present;  //!< Whether stream index `i` is held, at position `i % capacity`
+
+  public:
+    uint64_t first_unassembled = 0;
+    uint64_t bytes_read = 0;
+    size_t unassembled = 0;
+    bool eof_known = false;
+    uint64_t eof_index = 0;
+
+    explicit ReferenceReassembler(const size_t capacity) : _capacity(capacity), _present(capacity) {}
+
+    void push(const uint64_t index, const size_t len, const bool eof) {
+        const uint64_t window_end = bytes_read + _capacity;
+        if (eof and index + len <= window_end) {
+            eof_known = true;
+            eof_index = index + len;
+        }
+        for (uint64_t i = max(index, first_unassembled); i < min(index + len, window_end); ++i) {
+            if (not _present[i % _capacity]) {
+                _present[i % _capacity] = true;
+                ++unassembled;
+            }
+        }
+        while (_present[first_unassembled % _capacity]) {
+            _present[first_unassembled % _capacity] = false;
+            --unassembled;
+            ++first_unassembled;
+        }
+    }
+
+    bool ended() const { return eof_known and first_unassembled == eof_index; }
+};
+
+//! Compare the reassembler with the reference after an operation
+static void compare(const StreamReassembler &actual, const ReferenceReassembler &expected) {
+    const ByteStream &out = actual.stream_out();
+    if (out.bytes_written() != expected.first_unassembled) {
+        fuzz_fail(TARGET,
+                  "assembled " + to_string(out.bytes_written()) + " bytes, expected " +
+                      to_string(expected.first_unassembled));
+    }
+    if (out.bytes_read() != expected.bytes_read) {
+        fuzz_fail(TARGET, "output stream has a wrong bytes_read()");
+    }
+    if (actual.unassembled_bytes() != expected.unassembled) {
+        fuzz_fail(TARGET,
+                  "unassembled_bytes() is " + to_string(actual.unassembled_bytes()) + ", expected " +
+                      to_string(expected.unassembled));
+    }
+    if (actual.empty() != (expected.unassembled == 0)) {
+        fuzz_fail(TARGET, "empty() disagrees with unassembled_bytes()");
+    }
+    if (out.input_ended() != expected.ended()) {
+        fuzz_fail(TARGET, out.input_ended() ? "output ended early" : "output did not end at the eof index");
+    }
+}
+
+//! \details Input format: capacity (u16, at least 1), stream length (u16), then operations until the
+//! input runs out. An operation starts with a byte `op`:
+//!   - `op & 3` is 0-2: push a substring at (first unassembled + u16 - 512), at least 0, of u8 bytes,
+//!     clipped to the stream length; if `op & 4` and the end of the stream is at most 255 bytes
+//!     away, the substring instead runs to the end and carries eof
+//!   - `op & 3` is 3: read up to u8 bytes from the output, checking their contents
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    const FuzzBudget budget{TARGET, size, LIMITS};
+
+    Input in{data, size};
+    const size_t capacity = max<size_t>(1, in.u16());
+    const uint64_t stream_length = in.u16();
+
+    StreamReassembler actual{capacity};
+    ReferenceReassembler expected{capacity};
+    string substring;
+
+    while (not in.empty()) {
+        const uint8_t op = in.u8();
+        if ((op & 3) == 3) {
+            ByteStream &out = actual.stream_out();
+            const string bytes = out.read(in.u8());
+            for (size_t i = 0; i < bytes.size(); ++i) {
+                if (bytes[i] != stream_byte(expected.bytes_read + i)) {
+                    fuzz_fail(TARGET, "wrong byte at stream index " + to_string(expected.bytes_read + i));
+                }
+            }
+            expected.bytes_read += bytes.size();
+        } else {
+            const uint64_t offset = expected.first_unassembled + in.u16();
+            const uint64_t index = min(offset < 512 ? 0 : offset - 512, stream_length);
+            const uint64_t remaining = stream_length - index;
+            const bool eof = (op & 4) and remaining <= UINT8_MAX;
+            const size_t len = eof ? remaining : min<uint64_t>(in.u8(), remaining);
+
+            substring.resize(len);
+            for (size_t i = 0; i < len; ++i) {
+                substring[i] = stream_byte(index + i);
+            }
+            actual.push_substring(substring, index, eof);
+            expected.push(index, len, eof);
+        }
+        compare(actual, expected);
+    }
+
+    budget.check();
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include "fuzz_util.hh"
+
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+using namespace std;
+
+//! \file
+//! \brief Driver for the fuzz targets when they are not linked with libFuzzer (e.g., under g++)
+//! \details Runs the target once on every file named on the command line (directories are expanded
+//! one level, like a libFuzzer corpus), then on `-runs=N` random inputs of up to `-max_len=N` bytes
+//! drawn from a generator seeded with `-seed=N`. The flags have the same meaning as libFuzzer's, so
+//! the same command line works with either engine. There is no coverage feedback: this is for
+//! regression and smoke testing, not for finding new inputs.
+
+static void usage(const char *argv0) {
+    cerr << "Usage: " << argv0 << " [-runs=N] [-max_len=N] [-seed=N] [FILE|DIR]...\n";
+}
+
+//! \returns the contents of the file at `path`
+static string read_file(const string &path) {
+    ifstream in{path, ios::binary};
+    if (not in) {
+        throw runtime_error("cannot open " + path);
+    }
+    return {istreambuf_iterator<char>(in), istreambuf_iterator<char>()};
+}
+
+//! \returns `path` itself, or the regular files directly inside it if it is a directory
+static vector<string> expand(const string &path) {
+    struct stat st {};
+    if (::stat(path.c_str(), &st) != 0 or not S_ISDIR(st.st_mode)) {
+        return {path};
+    }
+
+    vector<string> files;
+    DIR *dir = ::opendir(path.c_str());
+    if (dir == nullptr) {
+        throw runtime_error("cannot open directory " + path);
+    }
+    while (const dirent *entry = ::readdir(dir)) {
+        const string file = path + "/" + entry->d_name;
+        if (::stat(file.c_str(), &st) == 0 and S_ISREG(st.st_mode)) {
+            files.push_back(file);
+        }
+    }
+    ::closedir(dir);
+    return files;
+}
+
+static void run(const string &input) {
+    LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t *>(input.data()), input.size());
+}
+
+int main(int argc, char *argv[]) {
+    try {
+        unsigned long runs = 1000;
+        size_t max_len = 4096;
+        unsigned long seed = 1;
+        vector<string> inputs;
+
+        for (int i = 1; i < argc; ++i) {
+            const string arg = argv[i];
+            if (arg.rfind("-runs=", 0) == 0) {
+                runs = stoul(arg.substr(strlen("-runs=")));
+            } else if (arg.rfind("-max_len=", 0) == 0) {
+                max_len = stoul(arg.substr(strlen("-max_len=")));
+            } else if (arg.rfind("-seed=", 0) == 0) {
+                seed = stoul(arg.substr(strlen("-seed=")));
+            } else if (arg.size() > 1 and arg[0] == '-') {
+                usage(argv[0]);
+                return EXIT_FAILURE;
+            } else {
+                for (auto &file : expand(arg)) {
+                    inputs.push_back(move(file));
+                }
+            }
+        }
+
+        for (const auto &path : inputs) {
+            run(read_file(path));
+        }
+
+        mt19937 rd{static_cast<mt19937::result_type>(seed)};
+        string input;
+        for (unsigned long i = 0; i < runs; ++i) {
+            input.resize(uniform_int_distribution<size_t>{0, max_len}(rd));
+            for (auto &ch : input) {
+                ch = static_cast<char>(rd());
+            }
+            run(input);
+        }
+
+        cerr << "Ran " << inputs.size() << " input file(s) and " << runs << " random input(s).\n";
+    } catch (const exception &e) {
+        cerr << argv[0] << ": " << e.what() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,41 @@
+#include "fuzz_util.hh"
+#include "parser.hh"
+#include "tcp_header.hh"
+
+#include <string>
+
+using namespace std;
+
+static const string TARGET = "fuzz_tcp_header";
+
+//! Parsing copies the input once; serializing and printing allocate a bounded amount
+static constexpr FuzzBudget::Limits LIMITS{20, 1, 256, 0, 16384, 4};
+
+//! \details If the input parses, the header must account for exactly `4 * doff` bytes, and
+//! serializing it must parse back to an identical header.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    const FuzzBudget budget{TARGET, size, LIMITS};
+
+    const Buffer segment{string{reinterpret_cast<const char *>(data), size}};
+    NetParser p{segment};
+    TCPHeader h{};
+    const ParseResult result = h.parse(p);
+    as_string(result);
+
+    if (result == ParseResult::NoError) {
+        if (h.doff < 5 or p.buffer().size() != size - 4 * size_t{h.doff}) {
+            fuzz_fail(TARGET, "parsed header is inconsistent with the segment: " + h.to_string());
+        }
+        h.summary();
+
+        const Buffer again{h.serialize()};
+        NetParser q{again};
+        TCPHeader h2{};
+        if (h2.parse(q) != ParseResult::NoError or not(h2 == h) or not q.buffer().str().empty()) {
+            fuzz_fail(TARGET, "serialized header does not parse back to the same header: " + h.to_string());
+        }
+    }
+
+    budget.check();
+    return 0;
+}
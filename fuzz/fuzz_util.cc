@@ -0,0 +1,96 @@
+#include "fuzz_util.hh"
+
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <new>
+
+using namespace std;
+
+static size_t allocations = 0;      //!< Calls to operator new so far
+static size_t allocated_bytes = 0;  //!< Bytes requested from operator new so far
+
+//! \details Counts every allocation for FuzzBudget. The array and nothrow forms of operator new
+//! forward to this one, and the default operator delete calls free().
+void *operator new(size_t size) {
+    ++allocations;
+    allocated_bytes += size;
+    if (void *ret = malloc(size == 0 ? 1 : size)) {
+        return ret;
+    }
+    throw bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { free(ptr); }
+
+void operator delete(void *ptr, size_t) noexcept { free(ptr); }
+
+//! \returns the factor from SPONGE_FUZZ_BUDGET_SCALE, or 1
+static double budget_scale() {
+    static const double scale = [] {
+        const char *env = getenv("SPONGE_FUZZ_BUDGET_SCALE");
+        const double value = env ? atof(env) : 0;
+        return value > 0 ? value : 1.0;
+    }();
+    return scale;
+}
+
+//! \returns false if SPONGE_FUZZ_NO_TIME_LIMIT is set (e.g., for smoke tests run in parallel)
+static bool time_limit_enabled() {
+    static const bool enabled = getenv("SPONGE_FUZZ_NO_TIME_LIMIT") == nullptr;
+    return enabled;
+}
+
+//! \returns the CPU time used by the calling thread, in milliseconds
+static double thread_cpu_ms() {
+    timespec now{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1e6;
+}
+
+FuzzBudget::FuzzBudget(const string &target, const size_t input_size, const Limits &limits)
+    : _target(target)
+    , _input_size(input_size)
+    , _limits(limits)
+    , _start_ms(thread_cpu_ms())
+    , _start_allocations(allocations)
+    , _start_allocated_bytes(allocated_bytes) {}
+
+void FuzzBudget::check() const {
+    const double scale = budget_scale();
+    const double n = _input_size;
+
+    const double elapsed_ms = thread_cpu_ms() - _start_ms;
+    const double time_limit_ms = scale * (_limits.base_ms + _limits.per_byte_us * n / 1000);
+    const double count = allocations - _start_allocations;
+    const double count_limit = scale * (_limits.base_allocations + _limits.per_byte_allocations * n);
+    const double bytes = allocated_bytes - _start_allocated_bytes;
+    const double bytes_limit = scale * (_limits.base_allocated_bytes + _limits.per_byte_allocated_bytes * n);
+
+    const auto report = [&](const char *resource, const double used, const double limit) {
+        cerr << "==FuzzBudget== " << _target << ": input of " << _input_size << " bytes used " << used << " "
+             << resource << " (budget " << limit << ")\n";
+    };
+
+    bool exceeded = false;
+    if (time_limit_enabled() and elapsed_ms > time_limit_ms) {
+        report("ms", elapsed_ms, time_limit_ms);
+        exceeded = true;
+    }
+    if (count > count_limit) {
+        report("allocations", count, count_limit);
+        exceeded = true;
+    }
+    if (bytes > bytes_limit) {
+        report("allocated bytes", bytes, bytes_limit);
+        exceeded = true;
+    }
+    if (exceeded) {
+        abort();
+    }
+}
+
+void fuzz_fail(const string &target, const string &what) {
+    cerr << "==FuzzCheck== " << target << ": " << what << "\n";
+    abort();
+}
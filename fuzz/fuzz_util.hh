@@ -0,0 +1,51 @@
+#ifndef SPONGE_FUZZ_FUZZ_UTIL_HH
+#define SPONGE_FUZZ_FUZZ_UTIL_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+//! Entry point of every fuzz target (called by libFuzzer or by fuzz_standalone.cc)
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+//! \brief Per-input time and allocation budget for a fuzz target
+//! \details The limits grow linearly with the input size, so an input that makes the code under test
+//! do quadratic work, or allocate quadratically, exceeds them even if nothing crashes. check() reports
+//! a violation and aborts, which fuzzing engines record as a finding just like a crash.
+//!
+//! Time is the CPU time of the calling thread, so other processes competing for the CPU do not count
+//! against an input. Allocations are counted by the replacement `operator new` in fuzz_util.cc. Set the
+//! environment variable SPONGE_FUZZ_BUDGET_SCALE (e.g., to 10 for sanitizer builds) to multiply every
+//! limit, and SPONGE_FUZZ_NO_TIME_LIMIT to check only the allocation limits.
+class FuzzBudget {
+  public:
+    //! The budget for an input of `n` bytes is `base + per_byte * n` for each resource
+    struct Limits {
+        double base_ms;                   //!< CPU time for an empty input
+        double per_byte_us;               //!< Additional time per input byte
+        size_t base_allocations;          //!< Calls to operator new for an empty input
+        size_t per_byte_allocations;      //!< Additional calls per input byte
+        size_t base_allocated_bytes;      //!< Bytes requested from operator new for an empty input
+        size_t per_byte_allocated_bytes;  //!< Additional bytes per input byte
+    };
+
+  private:
+    std::string _target;
+    size_t _input_size;
+    Limits _limits;
+    double _start_ms;
+    size_t _start_allocations;
+    size_t _start_allocated_bytes;
+
+  public:
+    //! Start measuring the processing of an input of `input_size` bytes
+    FuzzBudget(const std::string &target, const size_t input_size, const Limits &limits);
+
+    //! Abort with a report if the input has used more than its budget so far
+    void check() const;
+};
+
+//! Report that `target` found a bug (e.g., a mismatch with a reference model) and abort
+[[noreturn]] void fuzz_fail(const std::string &target, const std::string &what);
+
+#endif  // SPONGE_FUZZ_FUZZ_UTIL_HH
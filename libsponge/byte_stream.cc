@@ -18,50 +18,129 @@ size_t ByteStream::write(const string &data) {
     size_t len=min(remaining_capacity(),data.size());
     dataStream.append(BufferList(data.substr(0, len)));
     writeByte+=len;
+    _memory.set(buffer_size());
     return len;
 }
 
+//! \param[in] data is copied into one string (a single allocation), up to the remaining capacity
+size_t ByteStream::write(const BufferViewList &data) {
+    size_t len=min(remaining_capacity(),data.size());
+    string str;
+    str.reserve(len);
+    for (const auto &view : data.views()) {
+        if (str.size()==len) {
+            break;
+        }
+        str.append(view.substr(0, len-str.size()));
+    }
+    return append(move(str));
+}
+
+//! \param[in] iov is an array of `count` pieces, copied into one string up to the remaining capacity
+size_t ByteStream::write(const iovec *iov, const size_t count) {
+    size_t total=0;
+    for (size_t i=0;i<count;i++) {
+        total+=iov[i].iov_len;
+    }
+    size_t len=min(remaining_capacity(),total);
+    string str;
+    str.reserve(len);
+    for (size_t i=0;i<count and str.size()<len;i++) {
+        str.append(static_cast<const char *>(iov[i].iov_base), min(iov[i].iov_len, len-str.size()));
+    }
+    return append(move(str));
+}
+
+size_t ByteStream::append(string &&data) {
+    size_t len=data.size();
+    if (len==0) {
+        return 0;
+    }
+    dataStream.append(BufferList(move(data)));
+    writeByte+=len;
+    _memory.set(buffer_size());
+    return len;
+}
+
+//! \param[in] data is moved into the stream, except for the bytes that do not fit
+size_t ByteStream::write(BufferList &&data) {
+    size_t len=min(remaining_capacity(),data.size());
+    if (len==data.size()) {
+        dataStream.append(move(data));
+    } else {
+        dataStream.append(data.take_prefix(len));
+    }
+    writeByte+=len;
+    _memory.set(buffer_size());
+    return len;
+}
+
+//! \param[in] fd is read once (with readv), into a buffer that becomes part of the stream without a copy
+//! \param[in] limit caps the size of the read (and of the buffer allocated for it)
+size_t ByteStream::fill_from(FileDescriptor &fd, const size_t limit) {
+    const size_t len=min(remaining_capacity(),limit);
+    if (len==0) {
+        return 0;
+    }
+    const size_t filled=fd.read_into(dataStream, {len});
+    writeByte+=filled;
+    _memory.set(buffer_size());
+    if (fd.eof()) {
+        end_input();
+    }
+    return filled;
+}
+
 //! \param[in] len bytes will be copied from the output side of the buffer
+//! \note copies only the requested prefix, so peeking is not proportional to the buffered bytes
 string ByteStream::peek_output(const size_t len) const {
-    // 这里仅提供不安全的字符串复制，不判断边界条件，在read函数中进行判断
-    // if(len>0)
-    return std::string(dataStream.concatenate().data(), len);
-    // std::string str=dataStream.concatenate();
-    // if(len>=str.size()){
-    //     return str;
-    // }else{
-    //     // 直接从 std::string 的地址处返回前 len 个字符并不是一个安全或推荐的做法。
-    //     // 使用 substr 方法或其他标准方法来操作字符串，以确保代码的安全性和正确性。
-    //     return std::string(str.data(), len);
-    //     // return str.substr(0,len);
-    //     // 注意这个函数为const，因此不能调用一个非const的成员函数。
-    //     // dataStream.remove_prefix(len);
-    // }
+    const size_t length=min(len,buffer_size());
+    std::string str;
+    str.reserve(length);
+    for (const auto &buf : dataStream.buffers()) {
+        if (str.size()==length) {
+            break;
+        }
+        str.append(buf.str().substr(0, length-str.size()));
+    }
+    return str;
 }
 
 //! \param[in] len bytes will be removed from the output side of the buffer
 void ByteStream::pop_output(const size_t len) {
     dataStream.remove_prefix(len);
     readByte+=len;
+    _memory.set(buffer_size());
 }
 
 //! Read (i.e., copy and then pop) the next "len" bytes of the stream
 //! \param[in] len bytes will be popped and returned
 //! \returns a string
 std::string ByteStream::read(const size_t len) {
-    size_t length=min(dataStream.size(),len);
+    size_t length=min(buffer_size(),len);
     std::string str=peek_output(length);
     pop_output(length);
     return str;
 }
 
+//! \param[in] max_bytes is the most bytes to move out of the stream
+//! \returns the Buffers holding the next (up to) "max_bytes" bytes; a Buffer that straddles the
+//! end is split, and its remainder stays in the stream
+BufferList ByteStream::read_chunks(const size_t max_bytes) {
+    size_t length=min(buffer_size(),max_bytes);
+    BufferList chunks=dataStream.take_prefix(length);
+    readByte+=length;
+    _memory.set(buffer_size());
+    return chunks;
+}
+
 void ByteStream::end_input() {
     _end_input=true;
 }
 
 bool ByteStream::input_ended() const { return _end_input; }
 
-size_t ByteStream::buffer_size() const { return dataStream.size(); }
+size_t ByteStream::buffer_size() const { return writeByte-readByte; }
 
 bool ByteStream::buffer_empty() const { return !buffer_size(); }
 
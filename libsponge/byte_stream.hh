@@ -3,6 +3,8 @@
 
 #include <string>
 #include <buffer.hh>
+#include <file_descriptor.hh>
+#include <memory_accountant.hh>
 #include <iostream>
 //! \brief An in-order byte stream.
 
@@ -27,6 +29,11 @@ class ByteStream {
     bool _end_input{}; //! Signal that the byte stream has reached its ending
     bool _error{};  //!< Flag indicating that the stream suffered an error.
 
+    MemoryCharge _memory{};  //!< The buffered bytes, charged to MemoryAccountant::global()
+
+    //! Append `data` (already limited to the remaining capacity) as one Buffer
+    size_t append(std::string &&data);
+
   public:
     //! Construct a stream with room for `capacity` bytes.
     ByteStream(const size_t capacity);
@@ -39,6 +46,24 @@ class ByteStream {
     //! \returns the number of bytes accepted into the stream
     size_t write(const std::string &data);
 
+    //! Write the pieces of `data` into the stream as one Buffer. Write as many bytes
+    //! as will fit, and return how many were written.
+    //! \returns the number of bytes accepted into the stream
+    size_t write(const BufferViewList &data);
+
+    //! Write the `count` pieces at `iov` into the stream as one Buffer, like writev(2).
+    //! \returns the number of bytes accepted into the stream
+    size_t write(const iovec *iov, const size_t count);
+
+    //! Write the Buffers of `data` into the stream without copying their bytes. Write as
+    //! many bytes as will fit; the rest stay in `data`.
+    //! \returns the number of bytes accepted into the stream
+    size_t write(BufferList &&data);
+
+    //! Read from `fd` straight into the stream, as much as fits (up to `limit` bytes) in one read.
+    //! \returns the number of bytes read; the input is ended if `fd` reaches EOF
+    size_t fill_from(FileDescriptor &fd, const size_t limit = 65536);
+
     //! \returns the number of additional bytes that the stream has space for
     size_t remaining_capacity() const;
 
@@ -63,6 +88,10 @@ class ByteStream {
     //! \returns a string
     std::string read(const size_t len);
 
+    //! Read (i.e., move out) up to "max_bytes" bytes of the stream as its internal Buffers
+    //! \returns a BufferList sharing the stream's storage (no bytes are copied)
+    BufferList read_chunks(const size_t max_bytes);
+
     //! \returns `true` if the stream input has ended
     bool input_ended() const;
 
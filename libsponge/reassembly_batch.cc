@@ -0,0 +1,41 @@
+#include "reassembly_batch.hh"
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+using namespace std;
+
+//! Bring the state of `reassembler` into the cache ahead of its use
+static void prefetch(const StreamReassembler *reassembler) {
+    constexpr size_t CACHE_LINE = 64;
+    const char *bytes = reinterpret_cast<const char *>(reassembler);
+    for (size_t offset = 0; offset < sizeof(StreamReassembler); offset += CACHE_LINE) {
+        __builtin_prefetch(bytes + offset);
+    }
+}
+
+void ReassemblyBatch::add(StreamReassembler &reassembler, Buffer data, const uint64_t index, const bool eof) {
+    _segments.push_back({&reassembler, index, move(data), eof});
+}
+
+void ReassemblyBatch::apply() {
+    sort(_segments.begin(), _segments.end(), [](const Segment &a, const Segment &b) {
+        return less<const StreamReassembler *>{}(a.reassembler, b.reassembler) or
+               (a.reassembler == b.reassembler and a.index < b.index);
+    });
+
+    // start loading every reassembler of the batch at once, so their cache misses overlap instead
+    // of each stalling the push that needs it
+    for (auto it = _segments.begin(); it != _segments.end(); ++it) {
+        if (it == _segments.begin() or it->reassembler != prev(it)->reassembler) {
+            prefetch(it->reassembler);
+        }
+    }
+
+    for (auto &segment : _segments) {
+        segment.reassembler->push_substring(move(segment.data), segment.index, segment.eof);
+    }
+
+    _segments.clear();
+}
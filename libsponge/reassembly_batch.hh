@@ -0,0 +1,48 @@
+#ifndef SPONGE_LIBSPONGE_REASSEMBLY_BATCH_HH
+#define SPONGE_LIBSPONGE_REASSEMBLY_BATCH_HH
+
+#include "buffer.hh"
+#include "stream_reassembler.hh"
+
+#include <cstdint>
+#include <vector>
+
+//! \brief Substrings for many StreamReassemblers, collected from one receive batch and pushed together
+//! \details A batch of packets (from UDPSocket::recv_batch, a TUN device, or a PacketRingSocket)
+//! usually mixes segments of many connections. Pushing them in arrival order touches a different
+//! reassembler for nearly every segment, and each one's state is likely cold in the cache by the
+//! time its next segment comes. apply() instead groups the batch by reassembler and sorts each group
+//! by stream index, prefetches every reassembler in the batch at once, and then pushes each group in
+//! one pass. Sorted substrings also mostly arrive in order, so they take push_substring()'s fast
+//! path instead of being stored and assembled.
+//!
+//! The result is the same as pushing the substrings one at a time: reassembly does not depend on
+//! the order in which substrings arrive.
+class ReassemblyBatch {
+  private:
+    //! One substring, to be pushed into `reassembler`
+    struct Segment {
+        StreamReassembler *reassembler;
+        uint64_t index;
+        Buffer data;
+        bool eof;
+    };
+
+    std::vector<Segment> _segments{};
+
+  public:
+    //! Add a substring for `reassembler` (which must outlive the next apply())
+    //! \param data the substring
+    //! \param index indicates the index (place in sequence) of the first byte in `data`
+    //! \param eof the last byte of `data` will be the last byte in the entire stream
+    void add(StreamReassembler &reassembler, Buffer data, const uint64_t index, const bool eof);
+
+    //! Number of substrings waiting to be pushed
+    size_t size() const { return _segments.size(); }
+
+    //! Push every substring into its reassembler, grouped by reassembler and in index order, and
+    //! empty the batch
+    void apply();
+};
+
+#endif  // SPONGE_LIBSPONGE_REASSEMBLY_BATCH_HH
@@ -1,14 +1,8 @@
 #include "stream_reassembler.hh"
 
-// Dummy implementation of a stream reassembler.
-
-// For Lab 1, please replace with a real implementation that passes the
-// automated checks run by `make check_lab1`.
-
-// You will need to add private members to the class declaration in `stream_reassembler.hh`
-
-template <typename... Targs>
-void DUMMY_CODE(Targs &&... /* unused */) {}
+#include <algorithm>
+#include <iterator>
+#include <utility>
 
 using namespace std;
 
@@ -18,9 +12,193 @@ StreamReassembler::StreamReassembler(const size_t capacity) : _output(capacity),
 //! possibly out-of-order, from the logical stream, and assembles any newly
 //! contiguous substrings and writes them into the output stream in order.
 void StreamReassembler::push_substring(const string &data, const size_t index, const bool eof) {
-    DUMMY_CODE(data, index, eof);
+    const auto [begin, end] = _window(index, data.size(), eof);
+
+    if (begin < end) {
+        if (begin == _first_unassembled and _pending.empty()) {
+            // in-order fast path: nothing is waiting, so the bytes go straight to the output
+            const bool whole = begin == index and end == index + data.size();
+            _first_unassembled += _output.write(whole ? data : data.substr(begin - index, end - begin));
+        } else {
+            // the one copy of the early bytes: everything after this works on slices of it
+            _store(Buffer{data.substr(begin - index, end - begin)}, begin);
+            _assemble();
+            _shed();
+        }
+    }
+
+    if (_eof_known and _first_unassembled == _eof_index) {
+        _output.end_input();
+    }
+}
+
+//! \details As push_substring(const string &, ...), but the bytes are never copied here: the
+//! in-window part of `data` is either moved into the output or stored as a slice.
+void StreamReassembler::push_substring(Buffer data, const uint64_t index, const bool eof) {
+    const uint64_t data_end = index + data.size();
+    const auto [begin, end] = _window(index, data.size(), eof);
+
+    if (begin < end) {
+        data.remove_prefix(begin - index);
+        data.remove_suffix(data_end - end);
+        if (begin == _first_unassembled and _pending.empty()) {
+            _first_unassembled += _output.write(BufferList{move(data)});
+        } else {
+            _store(move(data), begin);
+            _assemble();
+            _shed();
+        }
+    }
+
+    if (_eof_known and _first_unassembled == _eof_index) {
+        _output.end_input();
+    }
+}
+
+//! \details Only bytes inside the window [first unassembled, first unread + capacity) are wanted;
+//! everything outside it is either already assembled or would exceed the capacity.
+pair<uint64_t, uint64_t> StreamReassembler::_window(const uint64_t index, const size_t size, const bool eof) {
+    const uint64_t window_end = _output.bytes_read() + _capacity;
+    const uint64_t data_end = index + size;
+
+    if (eof and data_end <= window_end) {
+        _eof_known = true;
+        _eof_index = data_end;
+    }
+
+    return {max<uint64_t>(index, _first_unassembled), min(data_end, window_end)};
+}
+
+void StreamReassembler::_store(Buffer data, uint64_t begin) {
+    uint64_t end = begin + data.size();
+
+    // trim against the stored substring that starts at or before `begin`
+    auto it = _pending.upper_bound(begin);
+    if (it != _pending.begin()) {
+        const auto prev = std::prev(it);
+        const uint64_t prev_end = prev->first + prev->second.size();
+        if (prev_end >= end) {
+            return;  // already have every byte
+        }
+        if (prev_end > begin) {
+            data.remove_prefix(prev_end - begin);
+            begin = prev_end;
+        }
+    }
+
+    // drop stored substrings that the new one covers, and stop at the first one it only overlaps
+    while (it != _pending.end() and it->first < end) {
+        const uint64_t next_end = it->first + it->second.size();
+        if (next_end > end) {
+            data.remove_suffix(end - it->first);
+            end = it->first;
+            break;
+        }
+        _unassembled_bytes -= it->second.size();
+        it = _pending.erase(it);
+    }
+
+    if (begin >= end) {
+        _memory.set(_unassembled_bytes);
+        return;
+    }
+
+    // merge with touching neighbours while the result stays small, so that a run of tiny
+    // substrings becomes one contiguous block instead of one node (and allocation) per substring
+    const bool join_prev = it != _pending.begin() and std::prev(it)->first + std::prev(it)->second.size() == begin and
+                           std::prev(it)->second.size() + data.size() <= SMALL_FRAGMENT;
+    const size_t prev_size = join_prev ? std::prev(it)->second.size() : 0;
+    const bool join_next = it != _pending.end() and it->first == end and
+                           prev_size + data.size() + it->second.size() <= SMALL_FRAGMENT;
+    if (join_prev or join_next) {
+        string merged;
+        merged.reserve(prev_size + data.size() + (join_next ? it->second.size() : 0));
+        if (join_prev) {
+            const auto prev = std::prev(it);
+            merged.append(prev->second.str());
+            begin = prev->first;
+            _unassembled_bytes -= prev->second.size();
+            _pending.erase(prev);
+        }
+        merged.append(data.str());
+        if (join_next) {
+            merged.append(it->second.str());
+            _unassembled_bytes -= it->second.size();
+            it = _pending.erase(it);
+        }
+        data = Buffer{move(merged)};
+    }
+
+    _unassembled_bytes += data.size();
+    _pending.emplace_hint(it, begin, move(data));
+    if (_pending.size() >= _compact_at) {
+        _compact();
+    }
+    _memory.set(_unassembled_bytes);
+}
+
+//! \details The next compaction waits until the number of pending substrings has doubled, so each
+//! byte is copied into a slab O(1) times on average.
+void StreamReassembler::_compact() {
+    _compact_at = max(COMPACT_MIN, 2 * _pending.size());
+
+    size_t slab_size = 0;
+    for (const auto &[index, piece] : _pending) {
+        if (piece.size() <= SMALL_FRAGMENT) {
+            slab_size += piece.size();
+        }
+    }
+    if (slab_size == 0) {
+        return;
+    }
+
+    string slab;
+    slab.reserve(slab_size);
+    for (const auto &[index, piece] : _pending) {
+        if (piece.size() <= SMALL_FRAGMENT) {
+            slab.append(piece.str());
+        }
+    }
+
+    const Buffer owner{move(slab)};
+    size_t offset = 0;
+    for (auto &[index, piece] : _pending) {
+        if (piece.size() <= SMALL_FRAGMENT) {
+            Buffer slice = owner;
+            slice.remove_prefix(offset);
+            slice.remove_suffix(slab_size - offset - piece.size());
+            offset += piece.size();
+            piece = move(slice);
+        }
+    }
+}
+
+void StreamReassembler::_assemble() {
+    while (not _pending.empty() and _pending.begin()->first == _first_unassembled) {
+        const auto head = _pending.begin();
+        _unassembled_bytes -= head->second.size();
+        _first_unassembled += _output.write(BufferList{move(head->second)});
+        _pending.erase(head);
+    }
+    if (_pending.empty()) {
+        _compact_at = COMPACT_MIN;
+    }
+    _memory.set(_unassembled_bytes);
+}
+
+void StreamReassembler::_shed() {
+    while (not _pending.empty() and MemoryAccountant::global().pressure() == MemoryAccountant::Pressure::Hard) {
+        const auto last = prev(_pending.end());
+        _unassembled_bytes -= last->second.size();
+        _pending.erase(last);
+        _memory.set(_unassembled_bytes);
+    }
+}
+
+size_t StreamReassembler::advertised_window() const {
+    return MemoryAccountant::global().scale_window(_output.remaining_capacity());
 }
 
-size_t StreamReassembler::unassembled_bytes() const { return {}; }
+size_t StreamReassembler::unassembled_bytes() const { return _unassembled_bytes; }
 
-bool StreamReassembler::empty() const { return {}; }
+bool StreamReassembler::empty() const { return _unassembled_bytes == 0; }
@@ -1,20 +1,60 @@
 #ifndef SPONGE_LIBSPONGE_STREAM_REASSEMBLER_HH
 #define SPONGE_LIBSPONGE_STREAM_REASSEMBLER_HH
 
+#include "buffer.hh"
 #include "byte_stream.hh"
+#include "memory_accountant.hh"
 
 #include <cstdint>
+#include <map>
 #include <string>
+#include <utility>
 
 //! \brief A class that assembles a series of excerpts from a byte stream (possibly out of order,
 //! possibly overlapping) into an in-order byte stream.
 class StreamReassembler {
   private:
-    // Your code here -- add private members as necessary.
+    //! Touching pending substrings are merged while the result is at most this long, and a
+    //! compaction copies substrings up to this long into one shared slab
+    static constexpr size_t SMALL_FRAGMENT = 256;
+
+    //! Fewest pending substrings worth compacting
+    static constexpr size_t COMPACT_MIN = 64;
 
     ByteStream _output;  //!< The reassembled in-order byte stream
     size_t _capacity;    //!< The maximum number of bytes
 
+    //! Substrings that arrived ahead of the next expected byte, keyed by stream index.
+    //! Stored substrings never overlap each other or the bytes already assembled; each is a slice
+    //! of the Buffer it arrived in, so trimming an overlap never copies.
+    std::map<uint64_t, Buffer> _pending{};
+
+    uint64_t _first_unassembled = 0;  //!< Stream index of the next byte to be written into _output
+    size_t _unassembled_bytes = 0;    //!< Total bytes held in _pending
+    bool _eof_known = false;          //!< Whether the index of the last byte of the stream is known
+    uint64_t _eof_index = 0;          //!< Stream index one past the last byte (valid if _eof_known)
+    size_t _compact_at = COMPACT_MIN;  //!< Compact once _pending holds this many substrings
+    MemoryCharge _memory{};           //!< _unassembled_bytes, charged to MemoryAccountant::global()
+
+    //! Note `eof`, and find the bytes of [index, index + size) that are wanted: [begin, end)
+    //! \returns `{begin, end}` (empty if no byte is wanted)
+    std::pair<uint64_t, uint64_t> _window(const uint64_t index, const size_t size, const bool eof);
+
+    //! Store the bytes of `data` (the slice [begin, begin + data.size()) of the stream) that are not
+    //! already held in _pending
+    void _store(Buffer data, uint64_t begin);
+
+    //! \brief Copy the small pending substrings into one slab and point them at it
+    //! \details Each small substring otherwise has its own allocation, or keeps alive the (possibly
+    //! much larger) Buffer it arrived in.
+    void _compact();
+
+    //! Move any pending substrings that are now contiguous with the output into _output
+    void _assemble();
+
+    //! At the hard memory limit, discard pending substrings, farthest first, until back under it
+    void _shed();
+
   public:
     //! \brief Construct a `StreamReassembler` that will store up to `capacity` bytes.
     //! \note This capacity limits both the bytes that have been reassembled,
@@ -31,6 +71,11 @@ class StreamReassembler {
     //! \param eof the last byte of `data` will be the last byte in the entire stream
     void push_substring(const std::string &data, const uint64_t index, const bool eof);
 
+    //! \brief Receive a substring held in a Buffer (e.g., a segment's payload), as push_substring()
+    //! \details Bytes that arrive in order are moved into the stream, and bytes that arrive early are
+    //! kept as slices of `data`: neither is copied. A stored slice keeps its whole Buffer alive.
+    void push_substring(Buffer data, const uint64_t index, const bool eof);
+
     //! \name Access the reassembled byte stream
     //!@{
     const ByteStream &stream_out() const { return _output; }
@@ -43,6 +88,10 @@ class StreamReassembler {
     //! should only be counted once for the purpose of this function.
     size_t unassembled_bytes() const;
 
+    //! \brief The receive window to advertise: the output's remaining capacity, shrunk under
+    //! memory pressure (see MemoryAccountant::scale_window)
+    size_t advertised_window() const;
+
     //! \brief Is the internal state empty (other than the output stream)?
     //! \returns `true` if no substrings are waiting to be assembled
     bool empty() const;
@@ -0,0 +1,106 @@
+#include "arp_message.hh"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+//! Read an Ethernet address as a 16-bit and a 32-bit integer
+//! \note Storing the bytes one at a time through an array reference trips a false
+//! -Wstringop-overflow in GCC's link-time optimizer (ReleaseLTO), so the array is built whole.
+static EthernetAddress parse_ethernet_address(NetParser &p) {
+    const uint16_t high = p.u16();
+    const uint32_t low = p.u32();
+    return {static_cast<uint8_t>(high >> 8),
+            static_cast<uint8_t>(high),
+            static_cast<uint8_t>(low >> 24),
+            static_cast<uint8_t>(low >> 16),
+            static_cast<uint8_t>(low >> 8),
+            static_cast<uint8_t>(low)};
+}
+
+//! \param[in] buffer is the serialized ARP message
+//! \returns a ParseResult indicating success, the reason for failure, or that the message is not
+//!          an Ethernet/IPv4 request or reply
+ParseResult ARPMessage::parse(const Buffer buffer) {
+    NetParser p{buffer};
+    hardware_type = p.u16();
+    protocol_type = p.u16();
+    hardware_address_size = p.u8();
+    protocol_address_size = p.u8();
+    opcode = p.u16();
+
+    if (p.error()) {
+        return p.get_error();
+    }
+
+    if (not supported()) {
+        return ParseResult::Unsupported;
+    }
+
+    // read sender addresses (Ethernet and IP)
+    sender_ethernet_address = parse_ethernet_address(p);
+    sender_ip_address = p.u32();
+
+    // read target addresses (Ethernet and IP)
+    target_ethernet_address = parse_ethernet_address(p);
+    target_ip_address = p.u32();
+
+    return p.get_error();
+}
+
+//! \returns `true` for Ethernet/IPv4 requests and replies
+bool ARPMessage::supported() const {
+    return hardware_type == TYPE_ETHERNET and protocol_type == EthernetHeader::TYPE_IPv4 and
+           hardware_address_size == sizeof(EthernetHeader::src) and protocol_address_size == sizeof(IPv4Header::src) and
+           ((opcode == OPCODE_REQUEST) or (opcode == OPCODE_REPLY));
+}
+
+//! Serialize the ARPMessage to a string
+string ARPMessage::serialize() const {
+    if (not supported()) {
+        throw runtime_error(
+            "ARPMessage::serialize(): unsupported field combination (must be Ethernet/IP, and request or reply)");
+    }
+
+    string ret;
+    ret.reserve(LENGTH);
+
+    NetUnparser::u16(ret, hardware_type);
+    NetUnparser::u16(ret, protocol_type);
+    NetUnparser::u8(ret, hardware_address_size);
+    NetUnparser::u8(ret, protocol_address_size);
+    NetUnparser::u16(ret, opcode);
+
+    // write sender addresses (Ethernet and IP)
+    for (auto byte : sender_ethernet_address) {
+        NetUnparser::u8(ret, byte);
+    }
+    NetUnparser::u32(ret, sender_ip_address);
+
+    // write target addresses (Ethernet and IP)
+    for (auto byte : target_ethernet_address) {
+        NetUnparser::u8(ret, byte);
+    }
+    NetUnparser::u32(ret, target_ip_address);
+
+    return ret;
+}
+
+//! \returns A string with the message's contents
+string ARPMessage::to_string() const {
+    stringstream ss{};
+    string opcode_str = "(unknown type)";
+    if (opcode == OPCODE_REQUEST) {
+        opcode_str = "REQUEST";
+    }
+    if (opcode == OPCODE_REPLY) {
+        opcode_str = "REPLY";
+    }
+    ss << "opcode=" << opcode_str << ", sender=" << ::to_string(sender_ethernet_address) << "/"
+       << inet_ntoa({htonl(sender_ip_address)}) << ", target=" << ::to_string(target_ethernet_address) << "/"
+       << inet_ntoa({htonl(target_ip_address)});
+    return ss.str();
+}
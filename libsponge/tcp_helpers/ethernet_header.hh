@@ -0,0 +1,42 @@
+#ifndef SPONGE_LIBSPONGE_ETHERNET_HEADER_HH
+#define SPONGE_LIBSPONGE_ETHERNET_HEADER_HH
+
+#include "parser.hh"
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+//! Helper type for an Ethernet address (an array of six bytes)
+using EthernetAddress = std::array<uint8_t, 6>;
+
+//! Ethernet broadcast address (ff:ff:ff:ff:ff:ff)
+constexpr EthernetAddress ETHERNET_BROADCAST = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+
+//! Printable representation of an EthernetAddress
+std::string to_string(const EthernetAddress address);
+
+//! \brief Ethernet frame header
+struct EthernetHeader {
+    static constexpr size_t LENGTH = 14;          //!< Ethernet header length in bytes
+    static constexpr uint16_t TYPE_IPv4 = 0x800;  //!< Type number for [IPv4](\ref rfc::rfc791)
+    static constexpr uint16_t TYPE_ARP = 0x806;   //!< Type number for [ARP](\ref rfc::rfc826)
+
+    //! \name Ethernet header fields
+    //!@{
+    EthernetAddress dst{};  //!< Destination address
+    EthernetAddress src{};  //!< Source address
+    uint16_t type{};        //!< Type of the payload
+    //!@}
+
+    //! Parse the Ethernet fields from the provided NetParser
+    ParseResult parse(NetParser &p);
+
+    //! Serialize the Ethernet fields to a string
+    std::string serialize() const;
+
+    //! Return a string containing a header in human-readable format
+    std::string to_string() const;
+};
+
+#endif  // SPONGE_LIBSPONGE_ETHERNET_HEADER_HH
@@ -0,0 +1,469 @@
+#ifndef SPONGE_LIBSPONGE_ASYNC_HH
+#define SPONGE_LIBSPONGE_ASYNC_HH
+
+#if not defined(__cpp_impl_coroutine)
+#error "async.hh requires C++20 coroutines: build the target with -std=c++20 (see SPONGE_HAVE_COROUTINES)"
+#endif
+
+#include "eventloop.hh"
+#include "file_descriptor.hh"
+#include "socket.hh"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <list>
+#include <new>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+//! \brief Free lists of fixed-size blocks for coroutine frames
+//! \details Frames are rounded up to a multiple of 64 bytes; each size up to 2 KiB has its own free
+//! list, and larger frames go straight to the heap. Blocks are never returned to the heap until the
+//! pool is destroyed, so a program that keeps starting similar coroutines stops allocating once the
+//! pool has warmed up.
+class FramePool {
+    static constexpr size_t GRANULE = 64;  //!< Frame sizes are rounded up to a multiple of this
+    static constexpr size_t CLASSES = 32;  //!< Number of pooled sizes (GRANULE to CLASSES * GRANULE bytes)
+
+    //! A free block, linked through its first bytes
+    struct FreeBlock {
+        FreeBlock *next;
+    };
+
+    std::array<FreeBlock *, CLASSES> _free{};  //!< One free list per size
+    size_t _blocks = 0;                        //!< Pooled blocks obtained from the heap
+
+    static size_t size_class(const size_t size) { return (size + GRANULE - 1) / GRANULE; }
+
+  public:
+    FramePool() = default;
+    FramePool(const FramePool &other) = delete;
+    FramePool &operator=(const FramePool &other) = delete;
+
+    ~FramePool() {
+        for (auto head : _free) {
+            while (head) {
+                ::operator delete(std::exchange(head, head->next));
+            }
+        }
+    }
+
+    //! Get a block of at least `size` bytes
+    void *allocate(const size_t size) {
+        const size_t cls = size_class(size);
+        if (cls > CLASSES) {
+            return ::operator new(size);
+        }
+        if (auto &head = _free[cls - 1]) {
+            return std::exchange(head, head->next);
+        }
+        ++_blocks;
+        return ::operator new(cls * GRANULE);
+    }
+
+    //! Return a block obtained from allocate(`size`)
+    void deallocate(void *block, const size_t size) {
+        const size_t cls = size_class(size);
+        if (cls > CLASSES) {
+            ::operator delete(block);
+            return;
+        }
+        _free[cls - 1] = ::new (block) FreeBlock{_free[cls - 1]};
+    }
+
+    //! Number of blocks the pool has taken from the heap
+    size_t blocks() const { return _blocks; }
+
+    //! The calling thread's pool, which holds the frames of every Task
+    static FramePool &local() {
+        thread_local FramePool pool;
+        return pool;
+    }
+};
+
+//! \brief State shared by the promises of every Task: the awaiting coroutine and any exception
+class TaskPromiseBase {
+  public:
+    std::coroutine_handle<> continuation{};  //!< The coroutine awaiting this one (none for a spawned Task)
+    std::exception_ptr exception{};          //!< Thrown out of the coroutine, rethrown to whoever awaits it
+    bool *finished = nullptr;                //!< Set when a spawned Task finishes, see AsyncLoop::spawn
+
+    //! Resumes the awaiting coroutine (symmetric transfer, so chains of Tasks use no stack)
+    class FinalAwaiter {
+      public:
+        bool await_ready() noexcept { return false; }
+
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            auto &promise = handle.promise();
+            if (promise.finished) {
+                *promise.finished = true;
+            }
+            return promise.continuation ? promise.continuation : std::noop_coroutine();
+        }
+
+        void await_resume() noexcept {}
+    };
+
+    //! \name Coroutine frames come from FramePool::local()
+    //!@{
+    static void *operator new(const size_t size) { return FramePool::local().allocate(size); }
+    static void operator delete(void *frame, const size_t size) { FramePool::local().deallocate(frame, size); }
+    //!@}
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    FinalAwaiter final_suspend() noexcept { return {}; }
+    void unhandled_exception() { exception = std::current_exception(); }
+
+    //! Rethrow the coroutine's exception, if any
+    void rethrow() const {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+};
+
+//! The part of a Task's promise that holds its result
+template <typename T>
+class TaskPromise : public TaskPromiseBase {
+    std::optional<T> _value{};
+
+  public:
+    template <typename U>
+    void return_value(U &&value) {
+        _value.emplace(std::forward<U>(value));
+    }
+
+    //! The value returned by the coroutine (or its exception, rethrown)
+    T result() {
+        rethrow();
+        return std::move(*_value);
+    }
+};
+
+//! The part of a Task's promise that holds its result (none)
+template <>
+class TaskPromise<void> : public TaskPromiseBase {
+  public:
+    void return_void() {}
+
+    //! Rethrow the coroutine's exception, if any
+    void result() { rethrow(); }
+};
+
+//! \brief A lazily started coroutine returning `T`, run by `co_await`ing it or by AsyncLoop::spawn
+//! \details A Task owns its coroutine frame, which is allocated from FramePool::local().
+template <typename T = void>
+class Task {
+  public:
+    //! Makes a coroutine returning Task<T>
+    class promise_type : public TaskPromise<T> {
+      public:
+        Task get_return_object() { return Task{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+    };
+
+  private:
+    friend class AsyncLoop;
+
+    std::coroutine_handle<promise_type> _handle{};  //!< The coroutine (empty once moved from)
+
+    explicit Task(const std::coroutine_handle<promise_type> handle) : _handle(handle) {}
+
+    //! Starts the coroutine when awaited, and resumes the awaiter when it finishes
+    class Awaiter {
+        std::coroutine_handle<promise_type> _handle;
+
+      public:
+        explicit Awaiter(const std::coroutine_handle<promise_type> handle) : _handle(handle) {}
+        bool await_ready() noexcept { return _handle.done(); }
+        std::coroutine_handle<> await_suspend(const std::coroutine_handle<> awaiting) noexcept {
+            _handle.promise().continuation = awaiting;
+            return _handle;
+        }
+        T await_resume() { return _handle.promise().result(); }
+    };
+
+  public:
+    Task(Task &&other) noexcept : _handle(std::exchange(other._handle, {})) {}
+    Task &operator=(Task &&other) noexcept {
+        if (this != &other) {
+            if (_handle) {
+                _handle.destroy();
+            }
+            _handle = std::exchange(other._handle, {});
+        }
+        return *this;
+    }
+    Task(const Task &other) = delete;
+    Task &operator=(const Task &other) = delete;
+
+    ~Task() {
+        if (_handle) {
+            _handle.destroy();
+        }
+    }
+
+    //! Has the coroutine run to completion?
+    bool done() const { return _handle and _handle.done(); }
+
+    //! Run the Task until it finishes, and return its result
+    Awaiter operator co_await() && { return Awaiter{_handle}; }
+};
+
+//! \brief Runs Task coroutines on an EventLoop
+//! \details Awaiting readable(), writable(), or an operation built on them adds an EventLoop rule for
+//! the fd, which cancels itself and resumes the coroutine once the fd is ready. Rules are recycled by
+//! EventLoop and their callbacks are stored inline, so waiting does not allocate. Awaiting sleep()
+//! puts the coroutine on a timer heap. AsyncLoop::run resumes coroutines until every spawned Task has
+//! finished, calling EventLoop::wait_next_event with a timeout that ends at the next timer.
+//!
+//! Because the rules share the EventLoop, coroutines can run alongside ordinary callback rules.
+//!
+//! The operations that read or write (read_some(), write_all(), accept()) expect non-blocking file
+//! descriptors (see FileDescriptor::set_blocking): they try the operation first and only wait when it
+//! reports FileDescriptor::would_block().
+class AsyncLoop {
+  public:
+    using Clock = std::chrono::steady_clock;  //!< Clock for sleep() deadlines
+
+  private:
+    //! A coroutine sleeping until `deadline` (`order` keeps timers with equal deadlines first-in, first-out)
+    struct Timer {
+        Clock::time_point deadline;
+        uint64_t order;
+        std::coroutine_handle<> waiter;
+
+        bool operator>(const Timer &other) const {
+            return deadline != other.deadline ? deadline > other.deadline : order > other.order;
+        }
+    };
+
+    EventLoop &_loop;                             //!< Polls the fds that coroutines wait on
+    std::list<Task<void>> _tasks{};               //!< Spawned tasks that have not finished
+    bool _finished = false;                       //!< Has any spawned task finished since the last sweep?
+    std::deque<std::coroutine_handle<>> _ready{};  //!< Coroutines to resume outside of EventLoop callbacks
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> _timers{};  //!< Sleeping coroutines
+    uint64_t _next_timer = 0;                                                        //!< Order of the next timer
+
+    //! Waits for `fd` to be ready in `direction`
+    class FdAwaiter {
+        EventLoop &_loop;
+        const FileDescriptor &_fd;
+        const Direction _direction;
+        std::deque<std::coroutine_handle<>> &_ready;
+        std::coroutine_handle<> _waiter{};
+        EventLoop::RuleHandle _rule{};
+        bool _fired = false;
+
+      public:
+        FdAwaiter(AsyncLoop &async, const FileDescriptor &fd, const Direction direction)
+            : _loop(async._loop), _fd(fd), _direction(direction), _ready(async._ready) {}
+        FdAwaiter(const FdAwaiter &other) = delete;
+        FdAwaiter &operator=(const FdAwaiter &other) = delete;
+
+        //! If the coroutine is destroyed while waiting, remove the rule that would resume it
+        ~FdAwaiter() {
+            _fired = true;
+            _rule.cancel();
+        }
+
+        bool await_ready() noexcept { return false; }
+
+        void await_suspend(const std::coroutine_handle<> waiter) {
+            _waiter = waiter;
+            _rule = _loop.add_rule(
+                _fd,
+                _direction,
+                [this] {
+                    _fired = true;
+                    _rule.cancel();  // the awaiter (and its rule) ends once the coroutine resumes
+                    _waiter.resume();
+                },
+                {},
+                [this] {
+                    // the EventLoop canceled the rule (EOF, closure, or hangup): the next read or write will tell
+                    if (not _fired) {
+                        _fired = true;
+                        _ready.push_back(_waiter);
+                    }
+                });
+        }
+
+        void await_resume() noexcept {}
+    };
+
+    //! Waits until `deadline`
+    class SleepAwaiter {
+        AsyncLoop &_async;
+        const Clock::time_point _deadline;
+
+      public:
+        SleepAwaiter(AsyncLoop &async, const Clock::time_point deadline) : _async(async), _deadline(deadline) {}
+        bool await_ready() noexcept { return _deadline <= Clock::now(); }
+        void await_suspend(const std::coroutine_handle<> waiter) {
+            _async._timers.push({_deadline, _async._next_timer++, waiter});
+        }
+        void await_resume() noexcept {}
+    };
+
+    //! Remove finished tasks, rethrowing the first exception that escaped one
+    void _reap() {
+        if (not std::exchange(_finished, false)) {
+            return;
+        }
+        for (auto it = _tasks.begin(); it != _tasks.end();) {
+            if (it->done()) {
+                const auto exception = it->_handle.promise().exception;
+                it = _tasks.erase(it);
+                if (exception) {
+                    std::rethrow_exception(exception);
+                }
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    //! Move timers whose deadline has passed to the ready queue
+    void _expire_timers() {
+        const auto now = Clock::now();
+        while (not _timers.empty() and _timers.top().deadline <= now) {
+            _ready.push_back(_timers.top().waiter);
+            _timers.pop();
+        }
+    }
+
+    //! Resume the coroutines in the ready queue (but not ones that become ready meanwhile)
+    void _resume_ready() {
+        for (size_t count = _ready.size(); count > 0; --count) {
+            const auto waiter = _ready.front();
+            _ready.pop_front();
+            waiter.resume();
+        }
+    }
+
+  public:
+    //! Run coroutines on `loop`, which must outlive the AsyncLoop
+    explicit AsyncLoop(EventLoop &loop) : _loop(loop) {}
+    AsyncLoop(const AsyncLoop &other) = delete;
+    AsyncLoop &operator=(const AsyncLoop &other) = delete;
+
+    //! Start `task` right away; once it first suspends, run() resumes it as it becomes ready
+    void spawn(Task<void> task) {
+        auto &spawned = _tasks.emplace_back(std::move(task));
+        spawned._handle.promise().finished = &_finished;
+        spawned._handle.resume();
+        _reap();
+    }
+
+    //! Resume coroutines until every spawned Task has finished; rethrows an exception that escapes a Task
+    void run() {
+        while (true) {
+            _expire_timers();
+            _resume_ready();
+            _reap();
+            if (_tasks.empty()) {
+                return;
+            }
+
+            int timeout_ms = -1;
+            if (not _ready.empty()) {
+                timeout_ms = 0;
+            } else if (not _timers.empty()) {
+                const auto wait = _timers.top().deadline - Clock::now();
+                timeout_ms = std::max(0, static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(wait).count()));
+            }
+
+            if (_loop.wait_next_event(timeout_ms) == EventLoop::Result::Exit) {
+                // no fd to poll: only timers can make progress
+                if (_timers.empty() and _ready.empty()) {
+                    throw std::runtime_error("AsyncLoop: tasks are waiting, but nothing can wake them");
+                }
+                if (_ready.empty()) {
+                    std::this_thread::sleep_until(_timers.top().deadline);
+                }
+            }
+            _reap();
+        }
+    }
+
+    //! \name Awaitables
+    //!@{
+
+    //! Wait until `fd` is readable (or at EOF, or hung up)
+    FdAwaiter readable(const FileDescriptor &fd) { return {*this, fd, Direction::In}; }
+
+    //! Wait until `fd` is writable (or hung up)
+    FdAwaiter writable(const FileDescriptor &fd) { return {*this, fd, Direction::Out}; }
+
+    //! Wait for `duration`
+    SleepAwaiter sleep(const Clock::duration duration) { return {*this, Clock::now() + duration}; }
+
+    //! Read up to `limit` bytes into `buffer` once some are available; returns the size read (0 at EOF)
+    Task<size_t> read_some(FileDescriptor &fd, std::string &buffer, const size_t limit = 65536) {
+        while (true) {
+            const auto result = fd.try_read(buffer, limit);
+            if (result) {
+                co_return result.bytes();
+            }
+            if (not result.would_block()) {
+                result.throw_error("read");
+            }
+            co_await readable(fd);
+        }
+    }
+
+    //! Write all of `data`, waiting for room as needed (the underlying storage must outlive the Task)
+    Task<void> write_all(FileDescriptor &fd, BufferViewList data) {
+        while (data.size() > 0) {
+            const auto result = fd.try_write(data);
+            if (result) {
+                data.remove_prefix(result.bytes());
+            } else if (result.would_block()) {
+                co_await writable(fd);
+            } else {
+                result.throw_error("writev");
+            }
+        }
+    }
+
+    //! Accept a connection on a listening (non-blocking) socket
+    Task<TCPSocket> accept(TCPSocket &listener) {
+        co_await readable(listener);
+        co_return listener.accept();
+    }
+    //!@}
+};
+
+//! \class AsyncLoop
+//! Example: an echo server that handles every connection in its own coroutine
+//!
+//! ~~~{.cc}
+//! Task<void> echo(AsyncLoop &async, TCPSocket sock) {
+//!     sock.set_blocking(false);
+//!     std::string buffer;
+//!     while (co_await async.read_some(sock, buffer) > 0) {
+//!         co_await async.write_all(sock, buffer);
+//!     }
+//! }
+//!
+//! Task<void> serve(AsyncLoop &async, TCPSocket &listener) {
+//!     while (true) {
+//!         async.spawn(echo(async, co_await async.accept(listener)));
+//!     }
+//! }
+//! ~~~
+
+#endif  // SPONGE_LIBSPONGE_ASYNC_HH
@@ -1,14 +1,27 @@
 #include "buffer.hh"
 
+#include <iterator>
+#include <utility>
+
 using namespace std;
 
 void Buffer::remove_prefix(const size_t n) {
     if (n > str().size()) {
         throw out_of_range("Buffer::remove_prefix");
     }
-    _starting_offset += n;
-    if (_storage and _starting_offset == _storage->size()) {
-        _storage.reset();
+    _view.remove_prefix(n);
+    if (_view.empty()) {
+        _owner.reset();
+    }
+}
+
+void Buffer::remove_suffix(const size_t n) {
+    if (n > str().size()) {
+        throw out_of_range("Buffer::remove_suffix");
+    }
+    _view.remove_suffix(n);
+    if (_view.empty()) {
+        _owner.reset();
     }
 }
 
@@ -18,6 +31,38 @@ void BufferList::append(const BufferList &other) {
     }
 }
 
+void BufferList::append(BufferList &&other) {
+    if (_buffers.empty()) {
+        _buffers = move(other._buffers);
+    } else {
+        move(other._buffers.begin(), other._buffers.end(), back_inserter(_buffers));
+    }
+    other._buffers.clear();
+}
+
+BufferList BufferList::take_prefix(size_t n) {
+    BufferList ret;
+    while (n > 0) {
+        if (_buffers.empty()) {
+            throw std::out_of_range("BufferList::take_prefix");
+        }
+
+        auto &front = _buffers.front();
+        if (n < front.size()) {
+            Buffer head = front;
+            head.remove_suffix(head.size() - n);
+            front.remove_prefix(n);
+            ret._buffers.push_back(move(head));
+            n = 0;
+        } else {
+            n -= front.size();
+            ret._buffers.push_back(move(front));
+            _buffers.pop_front();
+        }
+    }
+    return ret;
+}
+
 BufferList::operator Buffer() const {
     switch (_buffers.size()) {
         case 0:
@@ -1,8 +1,10 @@
 #ifndef SPONGE_LIBSPONGE_BUFFER_HH
 #define SPONGE_LIBSPONGE_BUFFER_HH
 
+#include "inline_queue.hh"
+
 #include <algorithm>
-#include <deque>
+#include <initializer_list>
 #include <memory>
 #include <numeric>
 #include <stdexcept>
@@ -14,23 +16,27 @@
 //! \brief A reference-counted read-only string that can discard bytes from the front
 class Buffer {
   private:
-    std::shared_ptr<std::string> _storage{};
-    size_t _starting_offset{};
+    std::shared_ptr<const void> _owner{};  //!< Keeps the bytes alive (normally a std::string)
+    std::string_view _view{};              //!< The bytes not yet discarded
 
   public:
     Buffer() = default;
 
     //! \brief Construct by taking ownership of a string
-    Buffer(std::string &&str) noexcept : _storage(std::make_shared<std::string>(std::move(str))) {}
+    Buffer(std::string &&str) noexcept {
+        auto storage = std::make_shared<const std::string>(std::move(str));
+        _view = *storage;
+        _owner = std::move(storage);
+    }
+
+    //! \brief Construct from bytes owned by something else (e.g., a block of a memory-mapped ring),
+    //! which `owner` keeps alive until the last copy of the Buffer lets go of them
+    Buffer(std::shared_ptr<const void> owner, const std::string_view bytes) noexcept
+        : _owner(std::move(owner)), _view(bytes) {}
 
     //! \name Expose contents as a std::string_view
     //!@{
-    std::string_view str() const {
-        if (not _storage) {
-            return {};
-        }
-        return {_storage->data() + _starting_offset, _storage->size() - _starting_offset};
-    }
+    std::string_view str() const { return _view; }
     // \brief 隐式转换为std::string_view类型使用
     operator std::string_view() const { return str(); }
     //!@}
@@ -47,6 +53,9 @@ class Buffer {
     //! \brief Discard the first `n` bytes of the string (does not require a copy or move)
     //! \note Doesn't free any memory until the whole string has been discarded in all copies of the Buffer.
     void remove_prefix(const size_t n);
+
+    //! \brief Discard the last `n` bytes of the string (does not require a copy or move)
+    void remove_suffix(const size_t n);
 };
 
 //! \brief A reference-counted discontiguous string that can discard bytes from the front
@@ -56,7 +65,8 @@ class Buffer {
 //! the TCPSegment in an IPv4Datagram) without copying the payload.
 class BufferList {
   private:
-    std::deque<Buffer> _buffers{};
+    //! Room for a payload and a few headers without allocating
+    InlineQueue<Buffer, 4> _buffers{};
 
   public:
     //! \name Constructors
@@ -75,11 +85,17 @@ class BufferList {
     //!@}
 
     //! \brief Access the underlying queue of Buffers
-    const std::deque<Buffer> &buffers() const { return _buffers; }
+    const InlineQueue<Buffer, 4> &buffers() const { return _buffers; }
 
     //! \brief Append a BufferList
     void append(const BufferList &other);
 
+    //! \brief Append a BufferList, moving its Buffers instead of copying them
+    void append(BufferList &&other);
+
+    //! \brief Remove the first `n` bytes and return them, moving whole Buffers (a Buffer split in two is shared)
+    BufferList take_prefix(size_t n);
+
     //! \brief Transform to a Buffer
     //! \note Throws an exception unless BufferList is contiguous
     //! 
@@ -97,7 +113,7 @@ class BufferList {
 
 //! \brief A non-owning temporary view (similar to std::string_view) of a discontiguous string
 class BufferViewList {
-    std::deque<std::string_view> _views{};
+    InlineQueue<std::string_view, 4> _views{};
 
   public:
     //! \name Constructors
@@ -114,8 +130,14 @@ class BufferViewList {
 
     //! \brief Construct from a std::string_view
     BufferViewList(std::string_view str) { _views.push_back({const_cast<char *>(str.data()), str.size()}); }
+
+    //! \brief Construct from several pieces (e.g., headers and a payload), in order
+    BufferViewList(std::initializer_list<std::string_view> pieces) : _views(pieces) {}
     //!@}
 
+    //! \brief Access the underlying queue of views
+    const InlineQueue<std::string_view, 4> &views() const { return _views; }
+
     //! \brief Discard the first `n` bytes of the string (does not require a copy or move)
     void remove_prefix(size_t n);
 
@@ -0,0 +1,144 @@
+#include "byte_ring.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+using namespace std;
+
+// Each side publishes its index with a release store and then, before deciding whether the other
+// side needs a wakeup (or whether it may sleep itself), issues a seq_cst fence and reloads the other
+// side's index. Of a producer that stores its index and a consumer that stores its own, at least one
+// therefore sees the other's store: either the consumer sees the new data and does not sleep, or
+// the producer sees that the consumer had caught up and notifies it (and the same for space).
+
+//! \param[in] capacity is the number of bytes the ring can hold (rounded up to a power of two)
+ByteRing::ByteRing(const size_t capacity) : _storage(), _mask(0) {
+    if (capacity == 0) {
+        throw runtime_error("ByteRing: capacity must be positive");
+    }
+    size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    _storage = make_unique<char[]>(size);
+    _mask = size - 1;
+}
+
+//! \param[in] data is the data to write
+//! \returns the number of bytes written (0 if the ring is full)
+size_t ByteRing::write(string_view data) {
+    const uint64_t w = _write_index.load(memory_order_relaxed);
+    const uint64_t r = _read_index.load(memory_order_acquire);
+    const size_t len = min(data.size(), capacity() - static_cast<size_t>(w - r));
+    if (len == 0) {
+        return 0;
+    }
+
+    const size_t offset = w & _mask;
+    const size_t first = min(len, capacity() - offset);
+    memcpy(&_storage[offset], data.data(), first);
+    memcpy(&_storage[0], data.data() + first, len - first);
+    _write_index.store(w + len, memory_order_release);
+
+    // wake the consumer if it had read everything (and so may be waiting)
+    atomic_thread_fence(memory_order_seq_cst);
+    if (_read_index.load(memory_order_relaxed) == w) {
+        _data_ready.ring();
+    }
+    return len;
+}
+
+//! \param[in] data is the data to write
+void ByteRing::write_all(string_view data) {
+    while (not data.empty()) {
+        const size_t len = write(data);
+        data.remove_prefix(len);
+        if (len == 0) {
+            wait_writable();
+        }
+    }
+}
+
+void ByteRing::end_input() {
+    _input_ended.store(true, memory_order_release);
+    _data_ready.ring();
+}
+
+size_t ByteRing::remaining_capacity() const {
+    return capacity() - (_write_index.load(memory_order_relaxed) - _read_index.load(memory_order_acquire));
+}
+
+void ByteRing::wait_writable() {
+    while (true) {
+        atomic_thread_fence(memory_order_seq_cst);
+        if (remaining_capacity() > 0) {
+            return;
+        }
+        _space_ready.wait();
+    }
+}
+
+//! \param[out] dest is where to copy the data
+//! \param[in] len is the maximum number of bytes to read
+//! \returns the number of bytes read (0 if the ring is empty)
+size_t ByteRing::read(char *dest, const size_t len) {
+    const uint64_t r = _read_index.load(memory_order_relaxed);
+    const size_t n = min(len, static_cast<size_t>(_write_index.load(memory_order_acquire) - r));
+
+    const size_t offset = r & _mask;
+    const size_t first = min(n, capacity() - offset);
+    memcpy(dest, &_storage[offset], first);
+    memcpy(dest + first, &_storage[0], n - first);
+    pop(n);
+    return n;
+}
+
+//! \param[in] limit is the maximum number of bytes to read
+string ByteRing::read(const size_t limit) {
+    string ret;
+    ret.resize(min(limit, buffer_size()));
+    ret.resize(read(ret.data(), ret.size()));
+    return ret;
+}
+
+string_view ByteRing::peek() const {
+    const uint64_t r = _read_index.load(memory_order_relaxed);
+    const size_t available = _write_index.load(memory_order_acquire) - r;
+    const size_t offset = r & _mask;
+    return {&_storage[offset], min(available, capacity() - offset)};
+}
+
+//! \param[in] len is the number of bytes to discard
+void ByteRing::pop(const size_t len) {
+    if (len == 0) {
+        return;
+    }
+    const uint64_t r = _read_index.load(memory_order_relaxed);
+    if (len > static_cast<size_t>(_write_index.load(memory_order_acquire) - r)) {
+        throw runtime_error("ByteRing::pop: more than the buffered bytes");
+    }
+    _read_index.store(r + len, memory_order_release);
+
+    // wake the producer if it had filled the ring (and so may be waiting)
+    atomic_thread_fence(memory_order_seq_cst);
+    if (_write_index.load(memory_order_relaxed) - r == capacity()) {
+        _space_ready.ring();
+    }
+}
+
+size_t ByteRing::buffer_size() const {
+    return _write_index.load(memory_order_acquire) - _read_index.load(memory_order_relaxed);
+}
+
+bool ByteRing::eof() const { return _input_ended.load(memory_order_acquire) and buffer_size() == 0; }
+
+void ByteRing::wait_readable() {
+    while (true) {
+        atomic_thread_fence(memory_order_seq_cst);
+        if (buffer_size() > 0 or _input_ended.load(memory_order_acquire)) {
+            return;
+        }
+        _data_ready.wait();
+    }
+}
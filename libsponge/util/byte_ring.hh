@@ -0,0 +1,103 @@
+#ifndef SPONGE_LIBSPONGE_BYTE_RING_HH
+#define SPONGE_LIBSPONGE_BYTE_RING_HH
+
+#include "doorbell.hh"
+#include "file_descriptor.hh"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+//! \brief A lock-free byte channel from one producer thread to one consumer thread
+//! \details A fixed-size ring buffer whose producer and consumer each own one index, so neither side
+//! takes a lock or makes a system call while the ring is neither empty nor full. Each side has an
+//! eventfd that becomes readable when the other side may have unblocked it: data_fd() after data
+//! arrives in an empty ring (or the input ends), space_fd() after space appears in a full ring. A
+//! thread can therefore wait with wait_readable()/wait_writable(), or put the fd in an EventLoop
+//! rule (whose callback calls clear_data_ready() or clear_space_ready() before using the ring).
+//!
+//! This is the channel between an application thread and a stack thread that owns the EventLoop:
+//! one ring per direction replaces a socketpair and the two extra copies through the kernel.
+class ByteRing {
+  private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    std::unique_ptr<char[]> _storage;  //!< The ring; its size is a power of two
+    size_t _mask;                      //!< Ring size minus one
+
+    alignas(CACHE_LINE) std::atomic<uint64_t> _write_index{0};  //!< Total bytes written (producer-owned)
+    alignas(CACHE_LINE) std::atomic<uint64_t> _read_index{0};   //!< Total bytes read (consumer-owned)
+    std::atomic<bool> _input_ended{false};                     //!< Has the producer called end_input()?
+
+    Doorbell _data_ready{};   //!< For the consumer: data arrived in an empty ring, or input ended
+    Doorbell _space_ready{};  //!< For the producer: space appeared in a full ring
+
+  public:
+    //! \param[in] capacity is the number of bytes the ring can hold (rounded up to a power of two)
+    explicit ByteRing(const size_t capacity);
+
+    //! Number of bytes the ring can hold
+    size_t capacity() const { return _mask + 1; }
+
+    //! \name Producer side
+    //!@{
+
+    //! Copy as much of `data` as fits into the ring, without blocking; returns the bytes written
+    size_t write(std::string_view data);
+
+    //! Copy all of `data` into the ring, blocking while it is full
+    void write_all(std::string_view data);
+
+    //! Signal that nothing more will be written
+    void end_input();
+
+    //! Bytes that could be written without blocking
+    size_t remaining_capacity() const;
+
+    //! Block until the ring has space
+    void wait_writable();
+
+    //! Readable when the ring may have space again; for EventLoop rules on the producer's thread
+    const FileDescriptor &space_fd() const { return _space_ready; }
+
+    //! Reset space_fd() (call before writing, in an EventLoop callback on space_fd())
+    void clear_space_ready() { _space_ready.clear(); }
+    //!@}
+
+    //! \name Consumer side
+    //!@{
+
+    //! Copy up to `len` bytes out of the ring into `dest`, without blocking; returns the bytes read
+    size_t read(char *dest, const size_t len);
+
+    //! Read up to `limit` bytes, without blocking
+    std::string read(const size_t limit);
+
+    //! The readable bytes that are contiguous in the ring (empty if nothing is buffered)
+    //! \note Use with pop() to consume data in place, e.g. straight into a ByteStream
+    std::string_view peek() const;
+
+    //! Discard the first `len` readable bytes (at most buffer_size())
+    void pop(const size_t len);
+
+    //! Bytes that could be read without blocking
+    size_t buffer_size() const;
+
+    //! Has the producer ended the input, with every byte read?
+    bool eof() const;
+
+    //! Block until the ring has data or the input has ended
+    void wait_readable();
+
+    //! Readable when the ring may have data again; for EventLoop rules on the consumer's thread
+    const FileDescriptor &data_fd() const { return _data_ready; }
+
+    //! Reset data_fd() (call before reading, in an EventLoop callback on data_fd())
+    void clear_data_ready() { _data_ready.clear(); }
+    //!@}
+};
+
+#endif  // SPONGE_LIBSPONGE_BYTE_RING_HH
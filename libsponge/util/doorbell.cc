@@ -0,0 +1,38 @@
+#include "doorbell.hh"
+
+#include "util.hh"
+
+#include <cerrno>
+#include <cstdint>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+using namespace std;
+
+Doorbell::Doorbell() : FileDescriptor(SystemCall("eventfd", ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))) {}
+
+void Doorbell::ring() const {
+    const uint64_t one = 1;
+    SystemCall("write", static_cast<int>(::write(fd_num(), &one, sizeof(one))), EAGAIN);
+}
+
+void Doorbell::clear() {
+    uint64_t count = 0;
+    const iovec counter{&count, sizeof(count)};
+    const auto result = try_read_into(&counter, 1);
+    if (not result and not result.would_block()) {
+        result.throw_error("read");
+    }
+}
+
+void Doorbell::wait() {
+    pollfd pfd{fd_num(), POLLIN, 0};
+    while (::poll(&pfd, 1, -1) < 0) {
+        if (errno != EINTR) {
+            throw unix_error("poll");
+        }
+    }
+    clear();
+}
@@ -0,0 +1,30 @@
+#ifndef SPONGE_LIBSPONGE_DOORBELL_HH
+#define SPONGE_LIBSPONGE_DOORBELL_HH
+
+#include "file_descriptor.hh"
+
+//! \brief A non-blocking [eventfd](\ref man2::eventfd) that wakes a thread or process waiting on a shared ring
+//! \details The ring's producer or consumer rings the doorbell when the other side may be waiting; that side
+//! waits with wait(), or polls the fd (e.g., in an EventLoop rule whose callback calls clear()). Ringing an
+//! already-rung doorbell, and clearing one that was not rung, are harmless. ring() uses only fd_num(), so
+//! it may be called from any thread; clear() and wait() count their reads like FileDescriptor::read (which
+//! EventLoop's busy-wait check relies on), so they belong to the one thread that waits on the doorbell.
+class Doorbell : public FileDescriptor {
+  public:
+    //! Construct a new eventfd
+    Doorbell();
+
+    //! Construct from an eventfd (e.g., received from another process)
+    explicit Doorbell(FileDescriptor &&fd) : FileDescriptor(std::move(fd)) {}
+
+    //! Make the fd readable
+    void ring() const;
+
+    //! Make the fd unreadable until the next ring()
+    void clear();
+
+    //! Block until the fd is readable, then clear()
+    void wait();
+};
+
+#endif  // SPONGE_LIBSPONGE_DOORBELL_HH
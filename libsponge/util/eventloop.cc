@@ -2,16 +2,313 @@
 
 #include "util.hh"
 
+#include <algorithm>
 #include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <memory>
+#include <chrono>
 #include <stdexcept>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
 #include <system_error>
+#include <unistd.h>
 #include <utility>
 #include <vector>
 
 using namespace std;
+using namespace std::chrono;
 
 unsigned int EventLoop::Rule::service_count() const {
-    return direction == Direction::In ? fd.read_count() : fd.write_count();
+    return direction == Direction::In ? fd->read_count() : fd->write_count();
+}
+
+void EventLoop::RuleHandle::cancel() {
+    if (valid()) {
+        _loop->_cancel(_rule);
+        _loop->_release_canceled();
+    }
+}
+
+void EventLoop::RuleHandle::pause() {
+    if (valid() and _rule->state == RuleState::Active) {
+        _loop->_paused.splice(_loop->_paused.end(), _loop->_rules, _rule);
+        _rule->state = RuleState::Paused;
+    }
+}
+
+void EventLoop::RuleHandle::resume() {
+    if (valid() and _rule->state == RuleState::Paused) {
+        _loop->_rules.splice(_loop->_rules.end(), _loop->_paused, _rule);
+        _rule->state = RuleState::Active;
+    }
+}
+
+//! \param[in] budget is the most callback calls per wakeup; 1 (the default) calls the callback once
+//! \details With a budget above 1, the rule's fd must be non-blocking: the callback is called again only
+//! while each call reads or writes the fd without hitting `EAGAIN`, so it finishes by finding the fd
+//! empty (or full). It should therefore use FileDescriptor::try_read or try_write, which report
+//! `EAGAIN` without throwing. Throws std::runtime_error if the fd is in blocking mode.
+void EventLoop::RuleHandle::set_drain_budget(const unsigned int budget) {
+    if (not valid()) {
+        return;
+    }
+    if (budget > 1 and _rule->fd->blocking()) {
+        throw runtime_error("EventLoop: a drain budget requires a non-blocking fd");
+    }
+    _rule->drain_budget = max(budget, 1U);
+}
+
+//! \param[in] rule is an active or paused rule
+void EventLoop::_cancel(const RuleList::iterator rule) {
+    RuleList &from = rule->state == RuleState::Active ? _rules : _paused;
+    _canceled.splice(_canceled.end(), from, rule);
+    rule->state = RuleState::Canceled;
+    rule->on_cancel();
+}
+
+//! \details A canceled rule's callbacks may be on the call stack (e.g., a callback that canceled
+//! its own rule), so they are only destroyed once no wait_next_event is in progress.
+void EventLoop::_release_canceled() {
+    if (_wait_depth > 0) {
+        return;
+    }
+    for (auto &rule : _canceled) {
+        rule.fd.reset();
+        rule.callback = nullptr;
+        rule.interest = nullptr;
+        rule.cancel = nullptr;
+        rule.id = 0;
+        rule.state = RuleState::Free;
+        rule.drain_budget = 1;
+        rule.stats = {};
+    }
+    _free.splice(_free.end(), _canceled);
+}
+
+//! \param[in] rule is an active rule whose fd was reported ready
+void EventLoop::_dispatch(const RuleList::iterator rule) {
+    auto &this_rule = *rule;
+    ++this_rule.stats.wakeups;
+
+    for (unsigned int calls = 0; calls < this_rule.drain_budget; ++calls) {
+        const auto count_before = this_rule.service_count();
+        ++this_rule.stats.callbacks;
+        this_rule.callback();
+
+        // the callback canceled or paused its own rule
+        if (this_rule.state != RuleState::Active) {
+            return;
+        }
+
+        if (count_before == this_rule.service_count()) {
+            // only the first call must make progress; a later one may simply have nothing left to do
+            if (calls == 0 and this_rule.interested()) {
+                throw runtime_error(
+                    "EventLoop: busy wait detected: callback did not read/write fd and is still interested");
+            }
+            return;
+        }
+
+        if (this_rule.fd->would_block() or (this_rule.direction == Direction::In and this_rule.fd->eof()) or
+            this_rule.fd->closed() or not this_rule.interested()) {
+            return;  // drained
+        }
+    }
+
+    if (this_rule.drain_budget > 1) {
+        // budget used up with the fd (possibly) still ready: let the other rules go first next time
+        ++this_rule.stats.exhausted;
+        _rules.splice(_rules.end(), _rules, rule);
+    }
+}
+
+EventLoop::EventLoop() : _wakeup(SystemCall("eventfd", ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))) {
+    sigemptyset(&_signal_mask);
+}
+
+EventLoop::~EventLoop() {
+    // functions that never got to run
+    for (auto *list : {_posted.exchange(nullptr), _posted_local}) {
+        while (list) {
+            delete exchange(list, list->next);
+        }
+    }
+}
+
+//! \param[in] fn is the function to run on the loop's thread
+//! \details Functions posted from one thread run in the order they were posted. The EventLoop
+//! must outlive every post() call.
+void EventLoop::post(CallbackT fn) {
+    auto *const node = new PostNode{move(fn), _posted.load(memory_order_relaxed)};
+    while (not _posted.compare_exchange_weak(node->next, node, memory_order_release, memory_order_relaxed)) {
+    }
+
+    // the first function posted since the last drain wakes the loop; the rest ride along
+    if (node->next == nullptr) {
+        _signal_wakeup();
+    }
+}
+
+void EventLoop::_signal_wakeup() {
+    const uint64_t one = 1;
+    // written directly rather than through FileDescriptor::write, whose counters belong to the loop thread
+    SystemCall("write", static_cast<int>(::write(_wakeup.fd_num(), &one, sizeof(one))), EAGAIN);
+}
+
+bool EventLoop::_run_posted() {
+    // consume the wakeup before taking the list, so that a post() after the exchange wakes us again
+    uint64_t count = 0;
+    SystemCall("read", static_cast<int>(::read(_wakeup.fd_num(), &count, sizeof(count))), EAGAIN);
+
+    // the posted list is newest first: reverse it onto the (oldest first) local list
+    PostNode *reversed = nullptr;
+    for (auto *node = _posted.exchange(nullptr, memory_order_acquire); node;) {
+        auto *const next = node->next;
+        node->next = reversed;
+        reversed = node;
+        node = next;
+    }
+    if (_posted_local) {
+        // left over from a function that threw; those go first
+        auto *tail = _posted_local;
+        while (tail->next) {
+            tail = tail->next;
+        }
+        tail->next = reversed;
+    } else {
+        _posted_local = reversed;
+    }
+
+    const bool any = _posted_local != nullptr;
+    while (_posted_local) {
+        const unique_ptr<PostNode> node{exchange(_posted_local, _posted_local->next)};
+        try {
+            node->fn();
+        } catch (...) {
+            // the rest of the list has already been drained: make sure the next wait_next_event runs it
+            if (_posted_local) {
+                _signal_wakeup();
+            }
+            throw;
+        }
+    }
+    return any;
+}
+
+//! \param[in] signum is the signal to handle, e.g. `SIGINT`
+//! \param[in] handler is called with `signum` during wait_next_event after the signal arrives
+//! \details The signal is blocked in the calling thread, which should be the loop's thread, so call
+//! this before starting other threads (they inherit the mask) or block the signal in them as well.
+void EventLoop::add_signal_handler(const int signum, SignalT handler) {
+    sigset_t one{};
+    sigemptyset(&one);
+    sigaddset(&one, signum);
+    if (const int error = pthread_sigmask(SIG_BLOCK, &one, nullptr)) {
+        throw unix_error("pthread_sigmask", error);
+    }
+
+    sigaddset(&_signal_mask, signum);
+    const int fd = SystemCall(
+        "signalfd", ::signalfd(_signals ? _signals->fd_num() : -1, &_signal_mask, SFD_NONBLOCK | SFD_CLOEXEC));
+    if (not _signals) {
+        _signals.emplace(fd);
+    }
+    _signal_handlers.emplace_back(signum, move(handler));
+}
+
+void EventLoop::_run_signal_handlers() {
+    signalfd_siginfo info{};
+    while (SystemCall("read", static_cast<int>(::read(_signals->fd_num(), &info, sizeof(info))), EAGAIN) > 0) {
+        for (const auto &[signum, handler] : _signal_handlers) {
+            if (signum == static_cast<int>(info.ssi_signo)) {
+                handler(signum);
+            }
+        }
+    }
+}
+
+//! \param[in] max_spin caps the adaptive spin budget; zero turns busy polling off
+void EventLoop::set_busy_poll(const microseconds max_spin) {
+    _max_spin = max(max_spin, microseconds{0});
+    _last_event.reset();
+    _busy_poll_stats = {};
+    _busy_poll_stats.spin_budget = _max_spin;
+}
+
+//! \param[in] now is when the event was found
+void EventLoop::_record_event(const steady_clock::time_point now) {
+    auto &stats = _busy_poll_stats;
+    if (_last_event) {
+        // exponentially weighted moving average, weight 1/8 for the newest gap
+        const auto gap = duration_cast<nanoseconds>(now - *_last_event);
+        stats.interarrival =
+            stats.interarrival.count() == 0 ? gap : stats.interarrival + (gap - stats.interarrival) / 8;
+        stats.spin_budget = stats.interarrival > _max_spin ? nanoseconds{0} : min(2 * stats.interarrival, _max_spin);
+    }
+    _last_event = now;
+}
+
+//! \param[in] pollfds are the fds to poll
+//! \param[in] timeout_ms is the timeout for the whole wait, as for poll(2) (negative: none)
+//! \returns the number of ready fds, or the failure of poll (e.g., `EINTR`)
+//! \details Spinning counts against `timeout_ms`.
+IOResult EventLoop::_poll(vector<pollfd> &pollfds, const int timeout_ms) {
+    const auto poll_once = [&pollfds](const int ms) {
+        const int ready = ::poll(pollfds.data(), pollfds.size(), ms);
+        return ready < 0 ? IOResult::failure(errno) : IOResult::success(ready);
+    };
+
+    if (_max_spin.count() == 0) {
+        return poll_once(timeout_ms);
+    }
+
+    auto &stats = _busy_poll_stats;
+    const auto start = steady_clock::now();
+    auto spin_limit = stats.spin_budget;
+    if (timeout_ms >= 0) {
+        spin_limit = min<nanoseconds>(spin_limit, milliseconds{timeout_ms});
+    }
+
+    // spin: poll without blocking until something is ready or the budget runs out
+    auto now = start;
+    if (spin_limit.count() > 0) {
+        do {
+            ++stats.spins;
+            const auto ready = poll_once(0);
+            now = steady_clock::now();
+            if (not ready) {
+                stats.spin_time += now - start;
+                return ready;
+            }
+            if (ready.bytes() > 0) {
+                ++stats.spin_wakeups;
+                stats.spin_time += now - start;
+                _record_event(now);
+                return ready;
+            }
+        } while (now - start < spin_limit);
+        stats.spin_time += now - start;
+    }
+
+    // give up spinning and sleep for the rest of the timeout
+    int remaining_ms = timeout_ms;
+    if (timeout_ms >= 0) {
+        remaining_ms = max(0, timeout_ms - static_cast<int>(duration_cast<milliseconds>(now - start).count()));
+    }
+    const auto ready = poll_once(remaining_ms);
+    if (ready and ready.bytes() > 0) {
+        ++stats.blocking_wakeups;
+        _record_event(steady_clock::now());
+    }
+    return ready;
+}
+
+//! \param[in] count is the number of rules to make room for, beyond those already free
+void EventLoop::reserve(const size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        _free.emplace_back();
+    }
 }
 
 //! \param[in] fd is the FileDescriptor to be polled
@@ -19,13 +316,32 @@ unsigned int EventLoop::Rule::service_count() const {
 //! \param[in] callback is called when `fd` is ready.
 //! \param[in] interest is called by EventLoop::wait_next_event. If it returns `true`, `fd` will
 //!                     be polled, otherwise `fd` will be ignored only for this execution of `wait_next_event.
-//! \param[in] cancel is called when the rule is cancelled (e.g. on hangup, EOF, or closure).
-void EventLoop::add_rule(const FileDescriptor &fd,
-                         const Direction direction,
-                         const CallbackT &callback,
-                         const InterestT &interest,
-                         const CallbackT &cancel) {
-    _rules.push_back({fd.duplicate(), direction, callback, interest, cancel});
+//!                     If empty, `fd` is always polled.
+//! \param[in] cancel is called when the rule is cancelled (e.g. on hangup, EOF, closure, or through
+//!                   RuleHandle::cancel), if not empty.
+//! \returns a handle to cancel, pause, or resume the rule
+EventLoop::RuleHandle EventLoop::add_rule(const FileDescriptor &fd,
+                                          const Direction direction,
+                                          CallbackT callback,
+                                          InterestT interest,
+                                          CallbackT cancel) {
+    RuleList::iterator rule;
+    if (_free.empty()) {
+        rule = _rules.emplace(_rules.end());
+    } else {
+        rule = _free.begin();
+        _rules.splice(_rules.end(), _free, rule);
+    }
+
+    rule->fd.emplace(fd.duplicate());
+    rule->direction = direction;
+    rule->callback = move(callback);
+    rule->interest = move(interest);
+    rule->cancel = move(cancel);
+    rule->id = _next_id++;
+    rule->state = RuleState::Active;
+
+    return {this, rule, rule->id};
 }
 
 //! \param[in] timeout_ms is the timeout value passed to [poll(2)](\ref man2::poll); `wait_next_event`
@@ -35,20 +351,24 @@ void EventLoop::add_rule(const FileDescriptor &fd,
 //! For each Rule, this function first calls Rule::interest; if `true`, Rule::fd is added to the
 //! list of file descriptors to be polled for readability (if Rule::direction == Direction::In) or
 //! writability (if Rule::direction == Direction::Out) unless Rule::fd has reached EOF, in which case
-//! the Rule is canceled (i.e., deleted from EventLoop::_rules).
+//! the Rule is canceled (i.e., moved out of EventLoop::_rules). Paused rules are not visited.
+//! Rule::interest must not add, cancel, pause, or resume rules.
 //!
 //! Next, this function calls [poll(2)](\ref man2::poll) with timeout value `timeout_ms`.
 //!
-//! Then, for each ready file descriptor, this function calls Rule::callback. If fd reaches EOF or
-//! if the Rule was registered using EventLoop::add_cancelable_rule and Rule::callback returns true,
-//! this Rule is canceled.
+//! Then, for each ready file descriptor, this function calls Rule::callback, unless an earlier
+//! callback in the same round canceled or paused that Rule. If fd hangs up, this Rule is canceled.
+//! Callbacks may add rules and cancel, pause, or resume any rule through its RuleHandle (rules
+//! added or resumed during the round are polled from the next call on). A callback may also call
+//! wait_next_event itself (e.g., to wait for a reply); the nested call polls with storage of its own.
 //!
 //! If an error occurs during polling, this function throws a std::runtime_error.
 //!
-//! If a [signal(7)](\ref man7::signal) was caught during polling or if EventLoop::_rules becomes empty,
-//! this function returns Result::Exit.
+//! If EventLoop::_rules becomes empty (or no rule is interested), this function runs the posted
+//! functions and returns Result::Exit, unless one of them added a rule.
 //!
-//! If a timeout occurred while polling (i.e., no fd became ready), this function returns Result::Timeout.
+//! If a timeout occurred while polling (i.e., no fd became ready), or if a [signal(7)](\ref man7::signal)
+//! with a handler of its own interrupted polling, this function returns Result::Timeout.
 //!
 //! Otherwise, this function returns Result::Success.
 //!
@@ -59,86 +379,111 @@ void EventLoop::add_rule(const FileDescriptor &fd,
 //! will result in a busy loop (poll returns on a ready file descriptor; file descriptor is not read or
 //! written, so it is still ready; the next call to poll will immediately return).
 EventLoop::Result EventLoop::wait_next_event(const int timeout_ms) {
-    vector<pollfd> pollfds{};
-    pollfds.reserve(_rules.size());
-    bool something_to_poll = false;
+    // canceled rules are released when the outermost wait_next_event returns (or throws)
+    class WaitScope {
+        EventLoop &_loop;
 
-    // set up the pollfd for each rule
-    for (auto it = _rules.cbegin(); it != _rules.cend();) {  // NOTE: it gets erased or incremented in loop body
-        const auto &this_rule = *it;
-        if (this_rule.direction == Direction::In && this_rule.fd.eof()) {
-            // no more reading on this rule, it's reached eof
-            this_rule.cancel();
-            it = _rules.erase(it);
-            continue;
+      public:
+        PollSet poll_set;  //!< This call's own storage (EventLoop::_poll_set, unless an outer call holds it)
+
+        explicit WaitScope(EventLoop &loop) : _loop(loop), poll_set(move(loop._poll_set)) { ++_loop._wait_depth; }
+        WaitScope(const WaitScope &other) = delete;
+        WaitScope &operator=(const WaitScope &other) = delete;
+        ~WaitScope() {
+            _loop._poll_set = move(poll_set);
+            --_loop._wait_depth;
+            _loop._release_canceled();
         }
+    } scope{*this};
 
-        if (this_rule.fd.closed()) {
-            this_rule.cancel();
-            it = _rules.erase(it);
+    auto &pollfds = scope.poll_set.pollfds;
+    auto &polled = scope.poll_set.rules;
+    pollfds.clear();
+    polled.clear();
+    bool something_to_poll = false;
+
+    // set up the pollfd for each active rule
+    for (auto it = _rules.begin(); it != _rules.end();) {  // NOTE: it gets canceled or incremented in loop body
+        const auto &this_rule = *it;
+        if ((this_rule.direction == Direction::In && this_rule.fd->eof()) or this_rule.fd->closed()) {
+            // no more reading on this rule (it's reached eof), or the fd was closed
+            _cancel(it++);
             continue;
         }
 
-        if (this_rule.interest()) {
-            pollfds.push_back({this_rule.fd.fd_num(), static_cast<short>(this_rule.direction), 0});
+        if (this_rule.interested()) {
+            pollfds.push_back({this_rule.fd->fd_num(), static_cast<short>(this_rule.direction), 0});
             something_to_poll = true;
         } else {
-            pollfds.push_back({this_rule.fd.fd_num(), 0, 0});  // placeholder --- we still want errors
+            pollfds.push_back({this_rule.fd->fd_num(), 0, 0});  // placeholder --- we still want errors
         }
+        polled.emplace_back(it, this_rule.id);
         ++it;
     }
 
-    // quit if there is nothing left to poll
+    // quit if there is nothing left to poll (unless a posted function adds something)
     if (not something_to_poll) {
-        return Result::Exit;
+        return _run_posted() and not _rules.empty() ? Result::Success : Result::Exit;
     }
 
-    // call poll -- wait until one of the fds satisfies one of the rules (writeable/readable)
-    try {
-        if (0 == SystemCall("poll", ::poll(pollfds.data(), pollfds.size(), timeout_ms))) {
-            return Result::Timeout;
-        }
-    } catch (unix_error const &e) {
-        if (e.code().value() == EINTR) {
-            return Result::Exit;
-        }
+    // the wakeup eventfd and the signalfd follow the rules' entries
+    pollfds.push_back({_wakeup.fd_num(), POLLIN, 0});
+    if (_signals) {
+        pollfds.push_back({_signals->fd_num(), POLLIN, 0});
     }
 
-    // go through the poll results
+    // call poll -- wait until one of the fds satisfies one of the rules (writeable/readable)
+    const auto ready = _poll(pollfds, timeout_ms);
+    if (ready.interrupted()) {
+        return Result::Timeout;  // interrupted by a signal that has a handler of its own: nothing happened
+    }
+    if (not ready) {
+        ready.throw_error("poll");
+    }
+    if (ready.bytes() == 0) {
+        return Result::Timeout;
+    }
 
-    for (auto [it, idx] = make_pair(_rules.begin(), size_t(0)); it != _rules.end(); ++idx) {
+    // go through the poll results (timing the callbacks when busy polling, to compare with the spinning)
+    const bool timed = _max_spin.count() > 0;
+    const auto work_start = timed ? steady_clock::now() : steady_clock::time_point{};
+    for (size_t idx = 0; idx < polled.size(); ++idx) {
         const auto &this_pollfd = pollfds[idx];
+        const auto [it, id] = polled[idx];
+
+        // an earlier callback may have canceled or paused this rule (and its node may have been reused)
+        if (it->id != id or it->state != RuleState::Active) {
+            continue;
+        }
 
         const auto poll_error = static_cast<bool>(this_pollfd.revents & (POLLERR | POLLNVAL));
         if (poll_error) {
             throw runtime_error("EventLoop: error on polled file descriptor");
         }
 
-        const auto &this_rule = *it;
         const auto poll_ready = static_cast<bool>(this_pollfd.revents & this_pollfd.events);
         const auto poll_hup = static_cast<bool>(this_pollfd.revents & POLLHUP);
         if (poll_hup && this_pollfd.events && !poll_ready) {
             // if we asked for the status, and the _only_ condition was a hangup, this FD is defunct:
             //   - if it was POLLIN and nothing is readable, no more will ever be readable
             //   - if it was POLLOUT, it will not be writable again
-            this_rule.cancel();
-            it = _rules.erase(it);
+            _cancel(it);
             continue;
         }
 
         if (poll_ready) {
             // we only want to call callback if revents includes the event we asked for
-            const auto count_before = this_rule.service_count();
-            this_rule.callback();
-
-            // only check for busy wait if we're not canceling or exiting
-            if (count_before == this_rule.service_count() and this_rule.interest()) {
-                throw runtime_error(
-                    "EventLoop: busy wait detected: callback did not read/write fd and is still interested");
-            }
+            _dispatch(it);
         }
-
-        ++it;  // if we got here, it means we didn't call _rules.erase()
+    }
+    if (pollfds[polled.size()].revents) {
+        _run_posted();
+    }
+    if (_signals and pollfds.size() > polled.size() + 1 and pollfds[polled.size() + 1].revents) {
+        _run_signal_handlers();
+    }
+    if (timed) {
+        _busy_poll_stats.work_time += steady_clock::now() - work_start;
     }
 
     return Result::Success;
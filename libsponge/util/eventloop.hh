@@ -2,11 +2,18 @@
 #define SPONGE_LIBSPONGE_EVENTLOOP_HH
 
 #include "file_descriptor.hh"
+#include "inline_function.hh"
 
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
 #include <cstdlib>
-#include <functional>
 #include <list>
+#include <optional>
 #include <poll.h>
+#include <utility>
+#include <vector>
 
 //! Waits for events on file descriptors and executes corresponding callbacks.
 class EventLoop {
@@ -17,41 +24,206 @@ class EventLoop {
         Out = POLLOUT  //!< Callback will be triggered when Rule::fd is writable.
     };
 
+    using CallbackT = InlineFunction<void(void)>;  //!< Callback for ready Rule::fd
+    using InterestT = InlineFunction<bool(void)>;  //!< `true` return indicates Rule::fd should be polled.
+    using SignalT = InlineFunction<void(int)>;     //!< Handler for a signal, called with the signal number
+
+    //! Fairness accounting for one rule, see RuleHandle::stats
+    struct RuleStats {
+        uint64_t wakeups = 0;    //!< Times the rule's fd was ready when polled
+        uint64_t callbacks = 0;  //!< Calls of the rule's callback (more than `wakeups` when draining)
+        uint64_t exhausted = 0;  //!< Wakeups that used up the whole drain budget
+    };
+
+    //! What busy polling has cost and bought, see EventLoop::set_busy_poll
+    struct BusyPollStats {
+        uint64_t spins = 0;                        //!< Non-blocking polls made while spinning
+        uint64_t spin_wakeups = 0;                 //!< Events found while spinning (each saved a sleep and wakeup)
+        uint64_t blocking_wakeups = 0;             //!< Events found by a blocking poll, after spinning or without
+        std::chrono::nanoseconds spin_time{0};     //!< Time spent spinning
+        std::chrono::nanoseconds work_time{0};     //!< Time spent in callbacks
+        std::chrono::nanoseconds spin_budget{0};   //!< Current adaptive spin budget
+        std::chrono::nanoseconds interarrival{0};  //!< Moving average of the time between events
+    };
+
   private:
-    using CallbackT = std::function<void(void)>;  //!< Callback for ready Rule::fd
-    using InterestT = std::function<bool(void)>;  //!< `true` return indicates Rule::fd should be polled.
+    //! Where a Rule's node currently lives
+    enum class RuleState {
+        Active,    //!< In EventLoop::_rules, polled by wait_next_event
+        Paused,    //!< In EventLoop::_paused, not polled
+        Canceled,  //!< In EventLoop::_canceled, waiting for its callbacks to be released
+        Free       //!< In EventLoop::_free, ready to be reused by add_rule
+    };
 
     //! \brief Specifies a condition and callback that an EventLoop should handle.
-    //! \details Created by calling EventLoop::add_rule() or EventLoop::add_cancelable_rule().
+    //! \details Created by calling EventLoop::add_rule().
     class Rule {
       public:
-        FileDescriptor fd;    //!< FileDescriptor to monitor for activity.
-        Direction direction;  //!< Direction::In for reading from fd, Direction::Out for writing to fd.
-        CallbackT callback;   //!< A callback that reads or writes fd.
-        InterestT interest;   //!< A callback that returns `true` whenever fd should be polled.
-        CallbackT cancel;     //!< A callback that is called when the rule is cancelled (e.g. on hangup)
+        std::optional<FileDescriptor> fd{};   //!< FileDescriptor to monitor for activity (empty once released).
+        Direction direction = Direction::In;  //!< Direction::In for reading from fd, Direction::Out for writing to fd.
+        CallbackT callback{};                 //!< A callback that reads or writes fd.
+        InterestT interest{};                 //!< Returns `true` whenever fd should be polled (empty: always).
+        CallbackT cancel{};                   //!< A callback that is called when the rule is cancelled (empty: none)
+        uint64_t id = 0;                      //!< Identifies this use of the node (0 when free), see RuleHandle
+        RuleState state = RuleState::Free;    //!< Which list holds the node
+        unsigned int drain_budget = 1;        //!< Most callback calls per wakeup, see RuleHandle::set_drain_budget
+        RuleStats stats{};                    //!< Fairness accounting
 
         //! Returns the number of times fd has been read or written, depending on the value of Rule::direction.
         //! \details This function is used internally by EventLoop; you will not need to call it
         unsigned int service_count() const;
+
+        //! Should fd be polled? (Rules without an `interest` callback always are, without a call.)
+        bool interested() const { return not interest or interest(); }
+
+        //! Call `cancel`, if any
+        void on_cancel() const {
+            if (cancel) {
+                cancel();
+            }
+        }
     };
 
-    std::list<Rule> _rules{};  //!< All rules that have been added and not canceled.
+    using RuleList = std::list<Rule>;
+
+    RuleList _rules{};     //!< Active rules, polled by wait_next_event.
+    RuleList _paused{};    //!< Paused rules, kept but not polled.
+    RuleList _canceled{};  //!< Canceled rules whose callbacks may still be running.
+    RuleList _free{};      //!< Nodes of released rules, reused by add_rule.
+
+    uint64_t _next_id = 1;         //!< Id for the next rule added
+    unsigned int _wait_depth = 0;  //!< Number of wait_next_event calls in progress
+
+    std::chrono::nanoseconds _max_spin{0};  //!< Upper bound on the spin budget (0: busy polling is off)
+    std::optional<std::chrono::steady_clock::time_point> _last_event{};  //!< When the last event was found
+    BusyPollStats _busy_poll_stats{};  //!< Accounting and adaptive state for busy polling
+
+    //! A function posted from another thread, linked into EventLoop::_posted
+    struct PostNode {
+        CallbackT fn;
+        PostNode *next;
+    };
+
+    FileDescriptor _wakeup;                                   //!< eventfd that post() writes to wake up the loop
+    std::atomic<PostNode *> _posted{nullptr};                 //!< Functions posted since the last drain, newest first
+    PostNode *_posted_local = nullptr;                        //!< Drained functions yet to run, oldest first
+    std::optional<FileDescriptor> _signals{};                 //!< signalfd for the signals of add_signal_handler
+    sigset_t _signal_mask{};                                  //!< The signals delivered through _signals
+    std::vector<std::pair<int, SignalT>> _signal_handlers{};  //!< Handler for each signal in _signal_mask
+
+    //! What one wait_next_event call polls
+    struct PollSet {
+        std::vector<pollfd> pollfds{};  //!< One entry per polled rule, then the eventfd and the signalfd
+        //! The rule (and its id, to detect reuse of the node) behind each rule entry of `pollfds`
+        std::vector<std::pair<RuleList::iterator, uint64_t>> rules{};
+    };
+
+    //! \brief Storage lent to each wait_next_event call, so that its capacity is reused
+    //! \details A call nested in a callback finds it taken by the outer call and uses storage of its
+    //! own, so the outer call's entries stay intact while it goes through them.
+    PollSet _poll_set{};
+
+    //! Cancel a rule: call its `cancel` callback and move it to _canceled
+    void _cancel(const RuleList::iterator rule);
+
+    //! Release the callbacks and fds of canceled rules, unless a callback may still be running
+    void _release_canceled();
+
+    //! Call a ready rule's callback, repeatedly if it has a drain budget
+    void _dispatch(const RuleList::iterator rule);
+
+    //! Poll `pollfds`, spinning first if busy polling is on; returns the number of ready fds, or the error
+    IOResult _poll(std::vector<pollfd> &pollfds, const int timeout_ms);
+
+    //! Update the inter-arrival average and the spin budget with an event found at `now`
+    void _record_event(const std::chrono::steady_clock::time_point now);
+
+    //! Make the next poll of EventLoop::_wakeup report it readable
+    void _signal_wakeup();
+
+    //! Run the functions posted so far, in order; returns whether there were any
+    //! \details If one of them throws, the rest stay queued and the wakeup is signaled again.
+    bool _run_posted();
+
+    //! Call the handlers of the signals that are pending on _signals
+    void _run_signal_handlers();
 
   public:
+    //! \brief Refers to a rule added with EventLoop::add_rule, to cancel, pause, or resume it later.
+    //! \details Every operation is O(1). Once the rule has been canceled (explicitly, or by the
+    //! EventLoop on EOF, closure, or hangup), the handle becomes invalid and its operations do nothing.
+    //! A RuleHandle must not be used after its EventLoop is destroyed.
+    class RuleHandle {
+        friend class EventLoop;
+
+        EventLoop *_loop = nullptr;  //!< The EventLoop holding the rule
+        RuleList::iterator _rule{};  //!< The rule's node
+        uint64_t _id = 0;            //!< The rule's id; the node is reused with a different id once released
+
+        RuleHandle(EventLoop *loop, const RuleList::iterator rule, const uint64_t id)
+            : _loop(loop), _rule(rule), _id(id) {}
+
+      public:
+        //! A handle that refers to no rule
+        RuleHandle() = default;
+        RuleHandle(const RuleHandle &other) = default;
+        RuleHandle &operator=(const RuleHandle &other) = default;
+
+        //! Does the rule still exist (i.e., has it not been canceled)?
+        bool valid() const { return _loop and _rule->id == _id and _rule->state != RuleState::Canceled; }
+
+        //! Is the rule paused?
+        bool paused() const { return valid() and _rule->state == RuleState::Paused; }
+
+        //! Remove the rule, calling its `cancel` callback. A callback may cancel its own rule.
+        void cancel();
+
+        //! Stop polling the rule's fd until resume()
+        void pause();
+
+        //! Poll the rule's fd again after pause()
+        void resume();
+
+        //! Let the callback run up to `budget` times per wakeup, until the fd would block
+        void set_drain_budget(const unsigned int budget);
+
+        //! Wakeups, callback calls, and exhausted drain budgets so far (all zero for an invalid handle)
+        RuleStats stats() const { return valid() ? _rule->stats : RuleStats{}; }
+    };
+
     //! Returned by each call to EventLoop::wait_next_event.
     enum class Result {
         Success,  //!< At least one Rule was triggered.
         Timeout,  //!< No rules were triggered before timeout.
-        Exit  //!< All rules have been canceled or were uninterested; make no further calls to EventLoop::wait_next_event.
+        Exit  //!< All rules have been canceled, paused, or were uninterested; make no further calls to EventLoop::wait_next_event.
     };
 
+    EventLoop();
+    ~EventLoop();
+    EventLoop(const EventLoop &other) = delete;
+    EventLoop &operator=(const EventLoop &other) = delete;
+
+    //! Run `fn` on the loop's thread during a later wait_next_event; safe to call from any thread
+    void post(CallbackT fn);
+
+    //! Handle `signum` with `handler` during wait_next_event instead of with a signal handler
+    void add_signal_handler(const int signum, SignalT handler);
+
     //! Add a rule whose callback will be called when `fd` is ready in the specified Direction.
-    void add_rule(const FileDescriptor &fd,
-                  const Direction direction,
-                  const CallbackT &callback,
-                  const InterestT &interest = [] { return true; },
-                  const CallbackT &cancel = [] {});
+    RuleHandle add_rule(const FileDescriptor &fd,
+                        const Direction direction,
+                        CallbackT callback,
+                        InterestT interest = {},
+                        CallbackT cancel = {});
+
+    //! Preallocate room for `count` more rules, so that adding them does not allocate
+    void reserve(const size_t count);
+
+    //! Spin on non-blocking polls for up to `max_spin` before each blocking poll (0 turns this off)
+    void set_busy_poll(const std::chrono::microseconds max_spin);
+
+    //! Spinning versus work done since busy polling was turned on
+    const BusyPollStats &busy_poll_stats() const { return _busy_poll_stats; }
 
     //! Calls [poll(2)](\ref man2::poll) and then executes callback for each ready fd.
     Result wait_next_event(const int timeout_ms);
@@ -69,8 +241,44 @@ using Direction = EventLoop::Direction;
 //! (for Rule::direction == Direction::In) or writable (for Rule::direction == Direction::Out).
 //! Once this occurs, the Rule is canceled, i.e., the EventLoop deletes it.
 //!
-//! A Rule installed using EventLoop::add_cancelable_rule will be polled and canceled under the
-//! same conditions, with the additional condition that if Rule::callback returns `true`, the
-//! Rule will be canceled.
+//! Callbacks are stored in InlineFunction objects, so lambdas with small captures are kept inside the
+//! Rule without heap allocation. Leaving out `interest` (always poll) or `cancel` (do nothing) costs
+//! no call at all in wait_next_event.
+//!
+//! A Rule can also be canceled, paused, and resumed explicitly through the RuleHandle that
+//! EventLoop::add_rule returns. Paused rules are kept on a separate list and are not polled at all,
+//! so the cost of each wait_next_event is proportional to the number of active rules. Rule nodes
+//! are recycled rather than freed, and EventLoop::reserve preallocates them.
+//!
+//! By default, a ready fd gets one call of its callback per wait_next_event, so a burst of N
+//! datagrams costs N calls to [poll(2)](\ref man2::poll). RuleHandle::set_drain_budget lets the
+//! callback run again right away, as long as each call reads (or writes) the fd and the fd has not
+//! reported `EAGAIN` (see FileDescriptor::would_block; the callback reads with FileDescriptor::try_read,
+//! say, since FileDescriptor::read throws on `EAGAIN`), reached EOF, or lost the rule's interest, up
+//! to the budget; the burst then costs one wakeup. A rule that uses up its budget moves to the back
+//! of the rule list, so other ready rules are served before it in the next round, and the fd (still
+//! readable) is picked up again by the next poll. RuleHandle::stats reports the accounting.
+//!
+//! For latency-critical loops, EventLoop::set_busy_poll trades CPU time for wakeup latency: before
+//! sleeping in [poll(2)](\ref man2::poll), wait_next_event polls without blocking until an event
+//! arrives or the spin budget runs out. The budget adapts to a moving average of the time between
+//! events: twice the average, capped at `max_spin`, and zero (no spinning) once events are usually
+//! further apart than `max_spin`, where spinning would mostly burn CPU. The average keeps being
+//! updated from blocking wakeups, so spinning resumes when traffic picks up again.
+//! EventLoop::busy_poll_stats reports the time spent spinning against the time spent in callbacks.
+//!
+//! Other threads hand work to the loop with EventLoop::post, which pushes the function onto a
+//! lock-free multi-producer, single-consumer list and, if the list was empty, writes to an
+//! [eventfd(2)](\ref man2::eventfd) that every wait_next_event polls. Only the first post after the
+//! loop has drained the list pays for the write, so a burst of posts costs one wakeup; the loop then
+//! runs all of them, in the order they were posted. Posted functions (like signal handlers) run
+//! alongside the rules' callbacks and may add or change rules, but the eventfd does not count as a
+//! rule: with no rules to poll, wait_next_event runs what has been posted and returns Result::Exit.
+//! A posted function that throws ends that wait_next_event; the ones posted after it run in the next.
+//!
+//! Signals given to EventLoop::add_signal_handler are blocked and delivered through a
+//! [signalfd(2)](\ref man2::signalfd) instead, so their handlers run on the loop thread, where they
+//! can touch any state. A signal interrupting [poll(2)](\ref man2::poll) therefore no longer ends
+//! the loop: wait_next_event reports it as Result::Timeout (nothing happened) and can be called again.
 
 #endif  // SPONGE_LIBSPONGE_EVENTLOOP_HH
@@ -3,11 +3,14 @@
 #include "util.hh"
 
 #include <algorithm>
+#include <array>
+#include <cerrno>
 #include <fcntl.h>
 #include <iostream>
 #include <stdexcept>
 #include <sys/uio.h>
 #include <unistd.h>
+#include <utility>
 
 using namespace std;
 
@@ -36,25 +39,51 @@ FileDescriptor::FDWrapper::~FDWrapper() {
 }
 
 //! \param[in] fd is the file descriptor number returned by [open(2)](\ref man2::open) or similar
-FileDescriptor::FileDescriptor(const int fd) : _internal_fd(make_shared<FDWrapper>(fd)) {}
+FileDescriptor::FileDescriptor(const int fd) : _internal_fd(new FDWrapper(fd)) {}
 
 //! Private constructor used by duplicate()
-//! duplicate 调用FileDescriptor(_internal_fd);时，通过值传递得到了other_shared_ptr，共享指针的计数+1
-//! 然后通过move语义将资源转移到_internal_fd
-FileDescriptor::FileDescriptor(shared_ptr<FDWrapper> other_shared_ptr) : _internal_fd(move(other_shared_ptr)) {}
+//! duplicate 调用FileDescriptor(_internal_fd);时，引用计数+1
+FileDescriptor::FileDescriptor(FDWrapper *other) : _internal_fd(other) { ++_internal_fd->_refs; }
+
+FileDescriptor::FileDescriptor(FileDescriptor &&other) noexcept : _internal_fd(exchange(other._internal_fd, nullptr)) {}
+
+FileDescriptor &FileDescriptor::operator=(FileDescriptor &&other) noexcept {
+    if (this != &other) {
+        release();
+        _internal_fd = exchange(other._internal_fd, nullptr);
+    }
+    return *this;
+}
+
+void FileDescriptor::release() {
+    if (_internal_fd and --_internal_fd->_refs == 0) {
+        delete _internal_fd;
+    }
+    _internal_fd = nullptr;
+}
 
 //! \returns a copy of this FileDescriptor
 //! 调用私有显式构造函数
 FileDescriptor FileDescriptor::duplicate() const { return FileDescriptor(_internal_fd); }
 
-//! \param[in] limit is the maximum number of bytes to read; fewer bytes may be returned
+//! \param[in] attempt is the name of the failed system call
+void IOResult::throw_error(const char *attempt) const { throw unix_error(attempt, _error); }
+
 //! \param[out] str is the string to be read
-void FileDescriptor::read(std::string &str, const size_t limit) {
+//! \param[in] limit is the maximum number of bytes to read; fewer bytes may be returned
+IOResult FileDescriptor::try_read(std::string &str, const size_t limit) {
     constexpr size_t BUFFER_SIZE = 1024 * 1024;  // maximum size of a read
     const size_t size_to_read = min(BUFFER_SIZE, limit);
     str.resize(size_to_read);
 
-    ssize_t bytes_read = SystemCall("read", ::read(fd_num(), str.data(), size_to_read));
+    const ssize_t bytes_read = ::read(fd_num(), str.data(), size_to_read);
+    const int error = bytes_read < 0 ? errno : 0;
+    register_would_block(error == EAGAIN);
+    if (error) {
+        str.clear();
+        return IOResult::failure(error);
+    }
+    register_read();
     if (limit > 0 && bytes_read == 0) {
         _internal_fd->_eof = true;
     }
@@ -62,8 +91,18 @@ void FileDescriptor::read(std::string &str, const size_t limit) {
         throw runtime_error("read() read more than requested");
     }
     str.resize(bytes_read);
+    return IOResult::success(bytes_read);
+}
 
-    register_read();
+//! \param[in] limit is the maximum number of bytes to read; fewer bytes may be returned
+//! \param[out] str is the string to be read
+//! \details Throws unix_error on failure, including `EAGAIN` on a non-blocking fd with nothing to
+//! read; try_read reports that without an exception.
+void FileDescriptor::read(std::string &str, const size_t limit) {
+    const auto result = try_read(str, limit);
+    if (not result) {
+        result.throw_error("read");
+    }
 }
 
 //! \param[in] limit is the maximum number of bytes to read; fewer bytes may be returned
@@ -76,23 +115,97 @@ string FileDescriptor::read(const size_t limit) {
     return ret;
 }
 
+//! \param[in] iov points to the regions to fill, in order (e.g., the two free parts of a ring buffer)
+//! \param[in] count is the number of regions
+//! \returns the number of bytes read (0 at EOF, or if a non-blocking fd had nothing to read)
+size_t FileDescriptor::read_into(const iovec *iov, const size_t count) {
+    const auto result = try_read_into(iov, count);
+    if (not result and not result.would_block()) {
+        result.throw_error("readv");
+    }
+    return result.bytes();  // 0 if a non-blocking fd had nothing to read
+}
+
+//! \param[in] iov points to the regions to fill, in order
+//! \param[in] count is the number of regions
+IOResult FileDescriptor::try_read_into(const iovec *iov, const size_t count) {
+    size_t requested = 0;
+    for (size_t i = 0; i < count; ++i) {
+        requested += iov[i].iov_len;
+    }
+
+    const ssize_t bytes_read = ::readv(fd_num(), iov, static_cast<int>(count));
+    const int error = bytes_read < 0 ? errno : 0;
+    register_would_block(error == EAGAIN);
+    if (error) {
+        return IOResult::failure(error);
+    }
+    register_read();
+    if (requested > 0 and bytes_read == 0) {
+        _internal_fd->_eof = true;
+    }
+    if (static_cast<size_t>(bytes_read) > requested) {
+        throw runtime_error("readv() read more than requested");
+    }
+    return IOResult::success(bytes_read);
+}
+
+//! \param[out] out gets one Buffer per region that received data, holding exactly the bytes read
+//! \param[in] sizes are the sizes of the regions to read into, e.g. `{header_size, mtu}` to get a
+//!                  packet's headers and its payload in separate buffers
+//! \returns the number of bytes read
+//! \details The bytes are read directly into the storage of the new Buffers. A region that ends up
+//! less than a quarter full is shrunk to fit (copying what was read), so that a short read does not
+//! pin a mostly empty allocation.
+size_t FileDescriptor::read_into(BufferList &out, const initializer_list<size_t> sizes) {
+    constexpr size_t MAX_REGIONS = 16;
+    if (sizes.size() > MAX_REGIONS) {
+        throw runtime_error("FileDescriptor::read_into: too many regions");
+    }
+
+    array<string, MAX_REGIONS> storage{};
+    array<iovec, MAX_REGIONS> iov{};
+    size_t count = 0;
+    for (const size_t size : sizes) {
+        storage[count].resize(size);
+        iov[count] = {storage[count].data(), size};
+        ++count;
+    }
+
+    const size_t bytes_read = read_into(iov.data(), count);
+
+    size_t left = bytes_read;
+    for (size_t i = 0; i < count and left > 0; ++i) {
+        const size_t filled = min(left, storage[i].size());
+        storage[i].resize(filled);
+        if (filled < storage[i].capacity() / 4) {
+            storage[i].shrink_to_fit();
+        }
+        out.append(Buffer{move(storage[i])});
+        left -= filled;
+    }
+    return bytes_read;
+}
+
+//! \param[in] buffer is the data to write
+//! \param[in] write_all is whether to keep writing until all of `buffer` is written
+//! \returns the number of bytes written
+//! \details Throws unix_error on failure, including `EAGAIN` on a non-blocking fd with no room;
+//! try_write reports that without an exception.
 size_t FileDescriptor::write(BufferViewList buffer, const bool write_all) {
     size_t total_bytes_written = 0;
 
     do {
-        auto iovecs = buffer.as_iovecs();
+        const auto result = try_write(buffer);
+        if (not result) {
+            result.throw_error("writev");
+        }
+        const size_t bytes_written = result.bytes();
 
-        const ssize_t bytes_written = SystemCall("writev", ::writev(fd_num(), iovecs.data(), iovecs.size()));
         if (bytes_written == 0 and buffer.size() != 0) {
             throw runtime_error("write returned 0 given non-empty input buffer");
         }
 
-        if (bytes_written > ssize_t(buffer.size())) {
-            throw runtime_error("write wrote more than length of input buffer");
-        }
-
-        register_write();
-
         buffer.remove_prefix(bytes_written);
 
         total_bytes_written += bytes_written;
@@ -101,6 +214,23 @@ size_t FileDescriptor::write(BufferViewList buffer, const bool write_all) {
     return total_bytes_written;
 }
 
+//! \param[in] buffer is the data to write; a non-blocking fd may accept only part of it
+IOResult FileDescriptor::try_write(const BufferViewList &buffer) {
+    const auto iovecs = buffer.as_iovecs();
+
+    const ssize_t bytes_written = ::writev(fd_num(), iovecs.data(), iovecs.size());
+    const int error = bytes_written < 0 ? errno : 0;
+    register_would_block(error == EAGAIN);
+    if (error) {
+        return IOResult::failure(error);
+    }
+    register_write();
+    if (bytes_written > ssize_t(buffer.size())) {
+        throw runtime_error("write wrote more than length of input buffer");
+    }
+    return IOResult::success(bytes_written);
+}
+
 void FileDescriptor::set_blocking(const bool blocking_state) {
     int flags = SystemCall("fcntl", fcntl(fd_num(), F_GETFL));
     if (blocking_state) {
@@ -111,3 +241,7 @@ void FileDescriptor::set_blocking(const bool blocking_state) {
 
     SystemCall("fcntl", fcntl(fd_num(), F_SETFL, flags));
 }
+
+bool FileDescriptor::blocking() const {
+    return not(SystemCall("fcntl", fcntl(fd_num(), F_GETFL)) & O_NONBLOCK);
+}
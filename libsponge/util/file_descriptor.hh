@@ -4,21 +4,68 @@
 #include "buffer.hh"
 
 #include <array>
+#include <cerrno>
 #include <cstddef>
+#include <initializer_list>
 #include <limits>
-#include <memory>
+#include <sys/uio.h>
+
+//! \brief The outcome of a non-throwing I/O call: a byte count, or the `errno` of a failure
+//! \details Returned by FileDescriptor::try_read and friends, which report every system call failure
+//! this way instead of throwing. `EAGAIN` on a non-blocking fd and `EINTR` are routine and cheap to
+//! check for; other errors can be turned into the usual unix_error with throw_error().
+class IOResult {
+    size_t _bytes = 0;  //!< Bytes transferred (when ok())
+    int _error = 0;     //!< `errno` of the failure, or 0
+
+  public:
+    //! A successful call that transferred `bytes` bytes
+    static IOResult success(const size_t bytes) {
+        IOResult ret;
+        ret._bytes = bytes;
+        return ret;
+    }
+
+    //! A failed call, with `errno` value `error`
+    static IOResult failure(const int error) {
+        IOResult ret;
+        ret._error = error;
+        return ret;
+    }
+
+    //! Did the call succeed?
+    bool ok() const { return _error == 0; }
+    explicit operator bool() const { return ok(); }
+
+    //! Bytes transferred (0 if the call failed)
+    size_t bytes() const { return _bytes; }
+
+    //! `errno` of the failure (0 if the call succeeded)
+    int error() const { return _error; }
+
+    //! Did the call fail because a non-blocking fd was not ready (`EAGAIN` / `EWOULDBLOCK`)?
+    bool would_block() const { return _error == EAGAIN or _error == EWOULDBLOCK; }
+
+    //! Did the call fail because a signal interrupted it (`EINTR`)?
+    bool interrupted() const { return _error == EINTR; }
+
+    //! Throw the unix_error that SystemCall would have thrown for this failure
+    [[noreturn]] void throw_error(const char *attempt) const;
+};
 
 //! A reference-counted handle to a file descriptor
 class FileDescriptor {
     //! \brief A handle on a kernel file descriptor.
-    //! \details FileDescriptor objects contain a std::shared_ptr to a FDWrapper.
+    //! \details FileDescriptor objects contain a pointer to a FDWrapper, which counts them.
     class FDWrapper {
       public:
+        unsigned _refs = 1;         //!< The number of FileDescriptor objects pointing to this FDWrapper
         int _fd;                    //!< The file descriptor number returned by the kernel
         bool _eof = false;          //!< Flag indicating whether FDWrapper::_fd is at EOF
         bool _closed = false;       //!< Flag indicating whether FDWrapper::_fd has been closed
         unsigned _read_count = 0;   //!< The number of times FDWrapper::_fd has been read
         unsigned _write_count = 0;  //!< The numberof times FDWrapper::_fd has been written
+        bool _would_block = false;  //!< Flag indicating whether the last read or write found nothing to do (`EAGAIN`)
 
         //! Construct from a file descriptor number returned by the kernel
         //! 必须显式的构造
@@ -39,24 +86,29 @@ class FileDescriptor {
         //!@}
     };
 
-    //! A reference-counted handle to a shared FDWrapper
-    std::shared_ptr<FDWrapper> _internal_fd;
+    //! The shared FDWrapper (nullptr once moved from); counted by FDWrapper::_refs, without atomics
+    FDWrapper *_internal_fd;
 
     // private constructor used to duplicate the FileDescriptor (increase the reference count)
     //! 私有显式构造函数，用于复制文件描述器
-    explicit FileDescriptor(std::shared_ptr<FDWrapper> other_shared_ptr);
+    explicit FileDescriptor(FDWrapper *other);
+
+    //! Drop this object's reference, destroying the FDWrapper (and closing the fd) if it was the last
+    void release();
 
   protected:
     void register_read() { ++_internal_fd->_read_count; }    //!< increment read count
     void register_write() { ++_internal_fd->_write_count; }  //!< increment write count
+    //! record whether the last read or write returned `EAGAIN`
+    void register_would_block(const bool would_block) { _internal_fd->_would_block = would_block; }
 
   public:
     //! Construct from a file descriptor number returned by the kernel
     //! 显式构造函数
     explicit FileDescriptor(const int fd);
 
-    //! Free the std::shared_ptr; the FDWrapper destructor calls close() when the refcount goes to zero.
-    ~FileDescriptor() = default;
+    //! Drop the reference; the FDWrapper destructor calls close() when the refcount goes to zero.
+    ~FileDescriptor() { release(); }
 
     //! Read up to `limit` bytes
     std::string read(const size_t limit = std::numeric_limits<size_t>::max());
@@ -64,6 +116,26 @@ class FileDescriptor {
     //! Read up to `limit` bytes into `str` (caller can allocate storage)
     void read(std::string &str, const size_t limit = std::numeric_limits<size_t>::max());
 
+    //! Read with one [readv(2)](\ref man2::readv) into `count` caller-owned regions; returns the bytes read
+    size_t read_into(const iovec *iov, const size_t count);
+
+    //! \name Non-throwing I/O
+    //! Like read, read_into, and write (without `write_all`), but failures come back as an IOResult
+    //!@{
+
+    //! Read up to `limit` bytes into `str` (which is left empty on failure)
+    IOResult try_read(std::string &str, const size_t limit = std::numeric_limits<size_t>::max());
+
+    //! Read with one readv into `count` caller-owned regions
+    IOResult try_read_into(const iovec *iov, const size_t count);
+
+    //! Write as much of `buffer` as one [writev(2)](\ref man2::writev) accepts
+    IOResult try_write(const BufferViewList &buffer);
+    //!@}
+
+    //! Read with one readv into new buffers of the given `sizes`, appending the filled ones to `out`
+    size_t read_into(BufferList &out, const std::initializer_list<size_t> sizes);
+
     //! Write a string, possibly blocking until all is written
     size_t write(const char *str, const bool write_all = true) { return write(BufferViewList(str), write_all); }
 
@@ -82,6 +154,9 @@ class FileDescriptor {
     //! Set blocking(true) or non-blocking(false)
     void set_blocking(const bool blocking_state);
 
+    //! Is the file descriptor in blocking mode? (This is a system call.)
+    bool blocking() const;
+
     //! \name FDWrapper accessors
     //!@{
 
@@ -99,6 +174,9 @@ class FileDescriptor {
 
     //! number of writes
     unsigned int write_count() const { return _internal_fd->_write_count; }
+
+    //! whether the last read or write of a non-blocking fd would have blocked
+    bool would_block() const { return _internal_fd->_would_block; }
     //!@}
 
     //! \name Copy/move constructor/assignment operators
@@ -106,15 +184,29 @@ class FileDescriptor {
     //!@{
     FileDescriptor(const FileDescriptor &other) = delete;             //!< \brief copy construction is forbidden
     FileDescriptor &operator=(const FileDescriptor &other) = delete;  //!< \brief copy assignment is forbidden
-    FileDescriptor(FileDescriptor &&other) = default;                 //!< \brief move construction is allowed
-    FileDescriptor &operator=(FileDescriptor &&other) = default;      //!< \brief move assignment is allowed
+    FileDescriptor(FileDescriptor &&other) noexcept;                  //!< \brief move construction is allowed
+    FileDescriptor &operator=(FileDescriptor &&other) noexcept;       //!< \brief move assignment is allowed
     //!@}
 };
 
 //! \class FileDescriptor
+//! Copies made with duplicate() share one FDWrapper, which closes the file descriptor when the
+//! last of them is destroyed. The reference count is a plain integer, not an atomic like that of a
+//! std::shared_ptr, so duplicating a FileDescriptor (as EventLoop::add_rule does) and destroying
+//! the copy cost no atomic read-modify-write instructions; the price is that the copies of a
+//! FileDescriptor must all be created and destroyed on one thread. (The fd number itself, from
+//! fd_num(), can be used from anywhere.)
+//!
 //! In addition, FileDescriptor tracks EOF state and calls to FileDescriptor::read and
 //! FileDescriptor::write, which EventLoop uses to detect busy loop conditions.
 //!
+//! On a non-blocking file descriptor (see set_blocking), read and write throw for `EAGAIN` like for
+//! any other failure, whereas try_read, try_read_into, and try_write report it in their IOResult
+//! (and read_into returns 0). Every attempt records in would_block() whether it found the fd not
+//! ready, which EventLoop uses to know when a draining callback (see
+//! EventLoop::RuleHandle::set_drain_budget) has emptied the fd; such callbacks use the try_* calls.
+//! Only attempts that succeed count in read_count() and write_count().
+//!
 //! For an example of FileDescriptor use, see the EventLoop class documentation.
 
 #endif  // SPONGE_LIBSPONGE_FILE_DESCRIPTOR_HH
@@ -0,0 +1,142 @@
+#ifndef SPONGE_LIBSPONGE_INLINE_FUNCTION_HH
+#define SPONGE_LIBSPONGE_INLINE_FUNCTION_HH
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+template <typename Signature, size_t Capacity = 4 * sizeof(void *)>
+class InlineFunction;
+
+//! \brief A move-only replacement for std::function that stores small callables inline
+//! \details Callables of at most `Capacity` bytes (e.g., lambdas capturing a few references or
+//! pointers) are constructed directly inside the object, so creating, moving, and destroying an
+//! InlineFunction does not allocate. Larger callables fall back to the heap. An empty InlineFunction
+//! (default-constructed or from `nullptr`) converts to `false`, which lets callers treat "no callable"
+//! as a cheap default instead of calling a do-nothing lambda.
+template <typename R, typename... Args, size_t Capacity>
+class InlineFunction<R(Args...), Capacity> {
+  private:
+    enum class Op { Move, Destroy };
+
+    using Invoker = R (*)(void *storage, Args &&... args);
+    using Manager = void (*)(Op op, void *storage, void *other);
+
+    template <typename F>
+    static constexpr bool stored_inline = sizeof(F) <= Capacity and alignof(F) <= alignof(std::max_align_t) and
+                                          std::is_nothrow_move_constructible_v<F>;
+
+    //! Callables that can be moved by copying their bytes and need no destructor get no manager
+    template <typename F>
+    static constexpr bool trivial = stored_inline<F> and std::is_trivially_copyable_v<F> and
+                                    std::is_trivially_destructible_v<F>;
+
+    alignas(std::max_align_t) mutable unsigned char _storage[Capacity];
+    Invoker _invoke = nullptr;   //!< Calls the stored callable; `nullptr` if empty
+    Manager _manage = nullptr;   //!< Moves or destroys the stored callable; `nullptr` if empty or trivial
+
+    template <typename F>
+    static F *inline_target(void *storage) {
+        return std::launder(reinterpret_cast<F *>(storage));
+    }
+
+    template <typename F>
+    static F *&heap_target(void *storage) {
+        return *std::launder(reinterpret_cast<F **>(storage));
+    }
+
+    template <typename F>
+    static R invoke_inline(void *storage, Args &&... args) {
+        return std::invoke(*inline_target<F>(storage), std::forward<Args>(args)...);
+    }
+
+    template <typename F>
+    static R invoke_heap(void *storage, Args &&... args) {
+        return std::invoke(*heap_target<F>(storage), std::forward<Args>(args)...);
+    }
+
+    template <typename F>
+    static void manage_inline(const Op op, void *storage, void *other) {
+        if (op == Op::Move) {
+            ::new (other) F(std::move(*inline_target<F>(storage)));
+        }
+        inline_target<F>(storage)->~F();
+    }
+
+    template <typename F>
+    static void manage_heap(const Op op, void *storage, void *other) {
+        if (op == Op::Move) {
+            ::new (other) F *(heap_target<F>(storage));
+        } else {
+            delete heap_target<F>(storage);
+        }
+    }
+
+    void reset() {
+        if (_manage) {
+            _manage(Op::Destroy, _storage, nullptr);
+        }
+        _invoke = nullptr;
+        _manage = nullptr;
+    }
+
+    void take(InlineFunction &other) {
+        if (other._manage) {
+            other._manage(Op::Move, other._storage, _storage);
+        } else if (other._invoke) {
+            std::memcpy(_storage, other._storage, Capacity);
+        }
+        _invoke = std::exchange(other._invoke, nullptr);
+        _manage = std::exchange(other._manage, nullptr);
+    }
+
+  public:
+    //! Construct an empty InlineFunction
+    InlineFunction() = default;
+
+    //! Construct an empty InlineFunction
+    InlineFunction(std::nullptr_t) {}
+
+    //! Construct from any callable with a compatible signature (e.g., a lambda)
+    template <typename F,
+              typename D = std::decay_t<F>,
+              typename = std::enable_if_t<not std::is_same_v<D, InlineFunction> and std::is_invocable_r_v<R, D &, Args...>>>
+    InlineFunction(F &&f) {
+        if constexpr (stored_inline<D>) {
+            ::new (static_cast<void *>(_storage)) D(std::forward<F>(f));
+            _invoke = &invoke_inline<D>;
+            _manage = trivial<D> ? nullptr : &manage_inline<D>;
+        } else {
+            ::new (static_cast<void *>(_storage)) D *(new D(std::forward<F>(f)));
+            _invoke = &invoke_heap<D>;
+            _manage = &manage_heap<D>;
+        }
+    }
+
+    ~InlineFunction() { reset(); }
+
+    //! \name Move-only
+    //!@{
+    InlineFunction(InlineFunction &&other) noexcept { take(other); }
+    InlineFunction &operator=(InlineFunction &&other) noexcept {
+        if (this != &other) {
+            reset();
+            take(other);
+        }
+        return *this;
+    }
+    InlineFunction(const InlineFunction &other) = delete;
+    InlineFunction &operator=(const InlineFunction &other) = delete;
+    //!@}
+
+    //! Is there a callable?
+    explicit operator bool() const { return _invoke != nullptr; }
+
+    //! Call the stored callable (which must exist)
+    R operator()(Args... args) const { return _invoke(_storage, std::forward<Args>(args)...); }
+};
+
+#endif  // SPONGE_LIBSPONGE_INLINE_FUNCTION_HH
@@ -0,0 +1,184 @@
+#ifndef SPONGE_LIBSPONGE_INLINE_QUEUE_HH
+#define SPONGE_LIBSPONGE_INLINE_QUEUE_HH
+
+#include <cstddef>
+#include <initializer_list>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+//! \brief A FIFO sequence that stores up to `Capacity` elements inline, and moves to the heap beyond that
+//! \details Elements are contiguous, as in a std::vector, but pop_front() only advances a head
+//! index; the slots it frees are reused (by moving the elements down) once the back reaches the
+//! end of the storage and at least half of it is free, and otherwise the storage doubles. A queue
+//! that never holds more than `Capacity` elements (e.g., a packet's headers and payload) never
+//! allocates, whereas a std::deque allocates its block map and a first block as soon as it holds
+//! anything.
+template <typename T, size_t Capacity>
+class InlineQueue {
+    static_assert(Capacity > 0, "InlineQueue: Capacity must be positive");
+    static_assert(std::is_nothrow_move_constructible_v<T>, "InlineQueue: elements are moved when the storage changes");
+
+  private:
+    alignas(T) unsigned char _inline[Capacity * sizeof(T)];
+    T *_data = reinterpret_cast<T *>(_inline);  //!< The inline storage, or a heap block
+    size_t _capacity = Capacity;                //!< Elements that fit in _data
+    size_t _head = 0;                           //!< Index in _data of the first element
+    size_t _tail = 0;                           //!< Index in _data one past the last element
+
+    bool on_heap() const { return _capacity != Capacity; }
+
+    //! Move the elements to the start of `storage` (which holds `capacity` elements), freeing the old heap block
+    void relocate(T *storage, const size_t capacity) {
+        const size_t count = size();
+        for (size_t i = 0; i < count; i++) {
+            ::new (static_cast<void *>(storage + i)) T(std::move(_data[_head + i]));
+            _data[_head + i].~T();
+        }
+        if (storage != _data) {
+            release();
+        }
+        _data = storage;
+        _capacity = capacity;
+        _head = 0;
+        _tail = count;
+    }
+
+    //! Free the heap block, if any (the elements must already be gone)
+    void release() {
+        if (on_heap()) {
+            ::operator delete(_data);
+        }
+    }
+
+    //! Make sure that there is storage for at least `count` elements from the head on
+    void reserve(const size_t count) {
+        if (count <= _capacity - _head) {
+            return;
+        }
+        if (count <= _capacity and _head >= size()) {
+            relocate(_data, _capacity);  // reuse the popped slots; the moved ranges do not overlap
+            return;
+        }
+        size_t capacity = 2 * _capacity;
+        while (capacity < count) {
+            capacity *= 2;
+        }
+        relocate(static_cast<T *>(::operator new(capacity * sizeof(T))), capacity);
+    }
+
+    //! Take the elements of `other`, leaving it empty
+    void take(InlineQueue &other) noexcept {
+        if (other.on_heap()) {
+            _data = std::exchange(other._data, reinterpret_cast<T *>(other._inline));
+            _capacity = std::exchange(other._capacity, Capacity);
+            _head = std::exchange(other._head, 0);
+            _tail = std::exchange(other._tail, 0);
+        } else {
+            for (auto &element : other) {
+                emplace_back(std::move(element));
+            }
+            other.clear();
+        }
+    }
+
+  public:
+    using value_type = T;
+    using iterator = T *;
+    using const_iterator = const T *;
+
+    InlineQueue() {}
+
+    InlineQueue(std::initializer_list<T> elements) {
+        reserve(elements.size());
+        for (const auto &element : elements) {
+            emplace_back(element);
+        }
+    }
+
+    InlineQueue(const InlineQueue &other) {
+        reserve(other.size());
+        for (const auto &element : other) {
+            emplace_back(element);
+        }
+    }
+
+    InlineQueue(InlineQueue &&other) noexcept { take(other); }
+
+    InlineQueue &operator=(const InlineQueue &other) {
+        if (this != &other) {
+            clear();
+            reserve(other.size());
+            for (const auto &element : other) {
+                emplace_back(element);
+            }
+        }
+        return *this;
+    }
+
+    InlineQueue &operator=(InlineQueue &&other) noexcept {
+        if (this != &other) {
+            clear();
+            release();
+            _data = reinterpret_cast<T *>(_inline);
+            _capacity = Capacity;
+            take(other);
+        }
+        return *this;
+    }
+
+    ~InlineQueue() {
+        clear();
+        release();
+    }
+
+    //! \name Elements, first to last
+    //!@{
+    T *begin() { return _data + _head; }
+    T *end() { return _data + _tail; }
+    const T *begin() const { return _data + _head; }
+    const T *end() const { return _data + _tail; }
+
+    T &front() { return _data[_head]; }
+    const T &front() const { return _data[_head]; }
+    T &back() { return _data[_tail - 1]; }
+    const T &back() const { return _data[_tail - 1]; }
+    T &operator[](const size_t n) { return _data[_head + n]; }
+    const T &operator[](const size_t n) const { return _data[_head + n]; }
+    //!@}
+
+    size_t size() const { return _tail - _head; }
+    bool empty() const { return _tail == _head; }
+
+    //! Construct an element at the back
+    template <typename... Args>
+    T &emplace_back(Args &&... args) {
+        if (_tail == _capacity) {
+            T element(std::forward<Args>(args)...);  // `args` may refer to an element that is about to move
+            reserve(size() + 1);
+            return *::new (static_cast<void *>(_data + _tail++)) T(std::move(element));
+        }
+        return *::new (static_cast<void *>(_data + _tail++)) T(std::forward<Args>(args)...);
+    }
+
+    void push_back(const T &element) { emplace_back(element); }
+    void push_back(T &&element) { emplace_back(std::move(element)); }
+
+    //! Remove the first element (the queue must not be empty)
+    void pop_front() {
+        _data[_head].~T();
+        if (++_head == _tail) {
+            _head = _tail = 0;
+        }
+    }
+
+    //! Remove every element (keeping any heap block for reuse)
+    void clear() {
+        for (auto &element : *this) {
+            element.~T();
+        }
+        _head = _tail = 0;
+    }
+};
+
+#endif  // SPONGE_LIBSPONGE_INLINE_QUEUE_HH
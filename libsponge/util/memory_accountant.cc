@@ -0,0 +1,72 @@
+#include "memory_accountant.hh"
+
+#include <stdexcept>
+
+using namespace std;
+
+thread_local ptrdiff_t MemoryAccountant::_local_bytes = 0;
+thread_local bool MemoryAccountant::_local_registered = false;
+
+MemoryAccountant &MemoryAccountant::global() {
+    static MemoryAccountant accountant;
+    return accountant;
+}
+
+void MemoryAccountant::_register_thread() {
+    //! Adds the thread's remaining delta to the global accountant when the thread exits
+    struct ExitFlush {
+        ExitFlush() = default;
+        ExitFlush(const ExitFlush &other) = delete;
+        ExitFlush &operator=(const ExitFlush &other) = delete;
+        ~ExitFlush() {
+            global()._usage.fetch_add(_local_bytes, memory_order_relaxed);
+            _local_bytes = 0;
+            _local_registered = false;
+        }
+    };
+    static thread_local ExitFlush exit_flush;
+    _local_registered = true;
+}
+
+//! \param[in] bytes is the charge (positive) or release (negative) that pushed the local delta past
+//! BATCH, or the first one made by this thread
+void MemoryAccountant::_flush(const ptrdiff_t bytes) {
+    if (not _local_registered) {
+        _register_thread();
+    }
+    _usage.fetch_add(_local_bytes + bytes, memory_order_relaxed);
+    _local_bytes = 0;
+}
+
+//! \param[in] soft is the usage above which windows shrink
+//! \param[in] hard is the usage at which windows close and out-of-order data is discarded
+void MemoryAccountant::set_limits(const size_t soft, const size_t hard) {
+    if (soft > hard) {
+        throw invalid_argument("MemoryAccountant: soft limit above hard limit");
+    }
+    _soft.store(soft, memory_order_relaxed);
+    _hard.store(hard, memory_order_relaxed);
+}
+
+MemoryAccountant::Pressure MemoryAccountant::pressure() const {
+    const size_t used = usage();
+    if (used >= hard_limit()) {
+        return Pressure::Hard;
+    }
+    return used > soft_limit() ? Pressure::Soft : Pressure::None;
+}
+
+//! \param[in] window is the window that the receiver would advertise without memory pressure
+size_t MemoryAccountant::scale_window(const size_t window) const {
+    const size_t used = usage();
+    const size_t soft = soft_limit();
+    const size_t hard = hard_limit();
+    if (used <= soft) {
+        return window;
+    }
+    if (used >= hard) {
+        return 0;
+    }
+    const double share = static_cast<double>(hard - used) / static_cast<double>(hard - soft);
+    return static_cast<size_t>(static_cast<double>(window) * share);
+}
@@ -0,0 +1,135 @@
+#ifndef SPONGE_LIBSPONGE_MEMORY_ACCOUNTANT_HH
+#define SPONGE_LIBSPONGE_MEMORY_ACCOUNTANT_HH
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+
+//! \brief Process-wide accounting of the bytes buffered by every ByteStream and StreamReassembler
+//! \details Each stream's capacity bounds only that stream; across many connections the capacities
+//! can add up to far more than the memory available. The accountant adds up what is actually
+//! buffered and compares it against two limits, in the manner of Linux's `tcp_mem`:
+//!
+//! * above the soft limit, receivers shrink the windows they advertise (see scale_window()), more
+//!   the closer usage gets to the hard limit;
+//! * at the hard limit, windows close and each StreamReassembler discards its farthest
+//!   out-of-order data to get back under it.
+//!
+//! Both limits are unlimited by default. Streams on different threads (e.g., one EventLoop per
+//! thread) share the global() accountant: like the kernel's per-CPU counters, each thread gathers
+//! its charges and releases locally and adds them to the shared atomic counter only once they net
+//! more than BATCH bytes either way. usage() adds in the calling thread's own delta, so a thread sees
+//! its charges and releases right away (a StreamReassembler discarding data at the hard limit stops
+//! as soon as it is back under), but may be off by up to BATCH bytes for each other thread.
+class MemoryAccountant {
+  public:
+    //! How close usage is to the limits
+    enum class Pressure { None, Soft, Hard };
+
+    //! The most bytes a thread charges or releases before updating the shared counter
+    static constexpr std::ptrdiff_t BATCH = 64 * 1024;
+
+  private:
+    //! Charges (positive) and releases (negative) made by this thread and not yet added to _usage
+    //! (plain thread-locals, so that reaching them costs no call to a TLS wrapper)
+    static thread_local std::ptrdiff_t _local_bytes;
+    static thread_local bool _local_registered;  //!< Will _local_bytes be added to _usage at thread exit?
+
+    //! Arrange for this thread's remaining delta to be added to _usage when the thread exits
+    static void _register_thread();
+
+    //! Add this thread's delta (plus `bytes`) to _usage
+    void _flush(const std::ptrdiff_t bytes);
+
+    std::atomic<std::ptrdiff_t> _usage{0};
+    std::atomic<size_t> _soft{std::numeric_limits<size_t>::max()};
+    std::atomic<size_t> _hard{std::numeric_limits<size_t>::max()};
+
+  public:
+    //! The accountant that ByteStream and StreamReassembler charge
+    static MemoryAccountant &global();
+
+    //! Set the soft and hard limits, in bytes (`soft` <= `hard`)
+    void set_limits(const size_t soft, const size_t hard);
+
+    //! Bytes currently charged (exactly for this thread's charges, give or take BATCH bytes per other thread)
+    size_t usage() const {
+        return std::max<std::ptrdiff_t>(_usage.load(std::memory_order_relaxed) + _local_bytes, 0);
+    }
+
+    //! The soft limit
+    size_t soft_limit() const { return _soft.load(std::memory_order_relaxed); }
+
+    //! The hard limit
+    size_t hard_limit() const { return _hard.load(std::memory_order_relaxed); }
+
+    //! Pressure at the current usage
+    Pressure pressure() const;
+
+    //! \brief Shrink a receive window to suit the current pressure
+    //! \returns `window` with no pressure, 0 at the hard limit, and in between a share of `window`
+    //! that falls linearly from all of it at the soft limit to none at the hard limit
+    size_t scale_window(const size_t window) const;
+
+    //! \name Charging (normally through a MemoryCharge)
+    //!@{
+    void charge(const size_t bytes) {
+        const std::ptrdiff_t delta = _local_bytes + static_cast<std::ptrdiff_t>(bytes);
+        if (delta > BATCH or not _local_registered) {
+            _flush(static_cast<std::ptrdiff_t>(bytes));
+        } else {
+            _local_bytes = delta;
+        }
+    }
+    void release(const size_t bytes) {
+        const std::ptrdiff_t delta = _local_bytes - static_cast<std::ptrdiff_t>(bytes);
+        if (delta < -BATCH or not _local_registered) {
+            _flush(-static_cast<std::ptrdiff_t>(bytes));
+        } else {
+            _local_bytes = delta;
+        }
+    }
+    //!@}
+};
+
+//! \brief The bytes one object (e.g., a ByteStream) has charged to MemoryAccountant::global()
+//! \details Released when the object is destroyed; a copy charges the same bytes again.
+class MemoryCharge {
+  private:
+    size_t _bytes = 0;
+
+  public:
+    MemoryCharge() = default;
+    ~MemoryCharge() { MemoryAccountant::global().release(_bytes); }
+
+    MemoryCharge(const MemoryCharge &other) : _bytes(other._bytes) { MemoryAccountant::global().charge(_bytes); }
+    MemoryCharge(MemoryCharge &&other) noexcept : _bytes(other._bytes) { other._bytes = 0; }
+    MemoryCharge &operator=(const MemoryCharge &other) {
+        set(other._bytes);
+        return *this;
+    }
+    MemoryCharge &operator=(MemoryCharge &&other) noexcept {
+        if (this != &other) {
+            MemoryAccountant::global().release(_bytes);
+            _bytes = other._bytes;
+            other._bytes = 0;
+        }
+        return *this;
+    }
+
+    //! Bytes charged
+    size_t bytes() const { return _bytes; }
+
+    //! Charge or release the difference, so that `bytes` are charged
+    void set(const size_t bytes) {
+        if (bytes > _bytes) {
+            MemoryAccountant::global().charge(bytes - _bytes);
+        } else if (bytes < _bytes) {
+            MemoryAccountant::global().release(_bytes - bytes);
+        }
+        _bytes = bytes;
+    }
+};
+
+#endif  // SPONGE_LIBSPONGE_MEMORY_ACCOUNTANT_HH
@@ -0,0 +1,288 @@
+#include "packet_channel.hh"
+
+#include "util.hh"
+
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+// The shared region is a Header, the two Rings, then ring 0's slots and ring 1's slots. A slot is a
+// 32-bit packet length followed (at offset SLOT_DATA) by up to Config::slot_size bytes of packet.
+// The indices synchronize as in ByteRing: each side publishes its index with a release store, then
+// issues a seq_cst fence before reading the other side's index to decide whether to ring a doorbell.
+
+static constexpr size_t CACHE_LINE = 64;
+static constexpr size_t SLOT_DATA = 8;
+static constexpr uint64_t MAGIC = 0x53504f4e47455331;  // "SPONGES1"
+
+struct SharedPacketChannel::Header {
+    uint64_t magic;
+    uint32_t slots;
+    uint32_t slot_size;
+};
+
+struct SharedPacketChannel::Ring {
+    alignas(CACHE_LINE) atomic<uint64_t> write_index{0};  //!< Packets sent (producer-owned)
+    alignas(CACHE_LINE) atomic<uint64_t> read_index{0};   //!< Packets received (consumer-owned)
+};
+
+static_assert(atomic<uint64_t>::is_always_lock_free, "shared-memory rings need address-free atomics");
+
+static constexpr size_t RINGS_OFFSET = CACHE_LINE;      //!< Offset of ring 0's indices (after the Header)
+static constexpr size_t RING_SIZE = 2 * CACHE_LINE;      //!< Size of one Ring
+static constexpr size_t SLOTS_OFFSET = RINGS_OFFSET + 2 * RING_SIZE;  //!< Offset of ring 0's first slot
+
+//! Bytes from one slot to the next, for packets of up to `slot_size` bytes
+static size_t slot_stride(const uint32_t slot_size) {
+    return (SLOT_DATA + slot_size + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+}
+
+//! Size of the shared region
+static size_t region_size(const SharedPacketChannel::Config &config) {
+    return SLOTS_OFFSET + 2 * size_t{config.slots} * slot_stride(config.slot_size);
+}
+
+//! \param[in] memory is the memfd
+//! \param[in] creator is whether to construct the rings (the memfd is new, with only its Header written)
+unique_ptr<char, SharedPacketChannel::Unmap> SharedPacketChannel::map(const FileDescriptor &memory,
+                                                                      const bool creator) {
+    static_assert(sizeof(Header) <= RINGS_OFFSET and sizeof(Ring) == RING_SIZE);
+
+    struct stat st {};
+    SystemCall("fstat", ::fstat(memory.fd_num(), &st));
+    const size_t length = st.st_size;
+    if (length < SLOTS_OFFSET) {
+        throw runtime_error("SharedPacketChannel: shared region too small");
+    }
+
+    void *addr = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, memory.fd_num(), 0);
+    if (addr == MAP_FAILED) {
+        throw unix_error("mmap");
+    }
+    unique_ptr<char, Unmap> region{static_cast<char *>(addr), Unmap{length}};
+
+    const Header &header = *launder(reinterpret_cast<Header *>(region.get()));
+    if (header.magic != MAGIC or header.slots == 0 or (header.slots & (header.slots - 1)) != 0 or
+        region_size({header.slots, header.slot_size}) != length) {
+        throw runtime_error("SharedPacketChannel: not a packet channel");
+    }
+
+    if (creator) {
+        for (size_t i = 0; i < 2; ++i) {
+            ::new (region.get() + RINGS_OFFSET + i * RING_SIZE) Ring{};
+        }
+    }
+    return region;
+}
+
+void SharedPacketChannel::Unmap::operator()(char *addr) const { ::munmap(addr, length); }
+
+//! \param[in] fds are the memfd (already holding a Header) and the four doorbells
+//! \param[in] creator is whether this end created the channel
+SharedPacketChannel::SharedPacketChannel(Fds fds, const bool creator)
+    : _fds(move(fds))
+    , _region(map(_fds[0], creator))
+    , _config({launder(reinterpret_cast<Header *>(_region.get()))->slots,
+               launder(reinterpret_cast<Header *>(_region.get()))->slot_size})
+    , _stride(slot_stride(_config.slot_size))
+    , _tx(direction(creator ? 0 : 1))
+    , _rx(direction(creator ? 1 : 0)) {}
+
+//! \param[in] ring_index is 0 (the creator sends) or 1 (the creator receives)
+SharedPacketChannel::Direction SharedPacketChannel::direction(const size_t ring_index) const {
+    return {launder(reinterpret_cast<Ring *>(_region.get() + RINGS_OFFSET + ring_index * RING_SIZE)),
+            _region.get() + SLOTS_OFFSET + ring_index * _config.slots * _stride,
+            Doorbell{_fds[1 + 2 * ring_index].duplicate()},
+            Doorbell{_fds[2 + 2 * ring_index].duplicate()}};
+}
+
+char *SharedPacketChannel::slot(const Direction &direction, const uint64_t index) const {
+    return direction.slots + (index & (_config.slots - 1)) * _stride;
+}
+
+//! \param[in] config is the number of slots per ring and the largest packet
+SharedPacketChannel SharedPacketChannel::create(const Config &config) {
+    if (config.slots == 0 or config.slot_size == 0) {
+        throw runtime_error("SharedPacketChannel: slots and slot size must be positive");
+    }
+    Header header{MAGIC, 1, config.slot_size};
+    while (header.slots < config.slots) {
+        header.slots <<= 1;
+    }
+
+    FileDescriptor memory{SystemCall("memfd_create", ::memfd_create("sponge-packet-channel", MFD_CLOEXEC))};
+    SystemCall("ftruncate", ::ftruncate(memory.fd_num(), region_size({header.slots, header.slot_size})));
+    SystemCall("pwrite", static_cast<int>(::pwrite(memory.fd_num(), &header, sizeof(header), 0)));
+
+    return {{move(memory), Doorbell{}, Doorbell{}, Doorbell{}, Doorbell{}}, true};
+}
+
+//! \param[in] socket is a Unix-domain socket connected to the peer, which calls receive_from()
+void SharedPacketChannel::send_to(const LocalStreamSocket &socket) const {
+    array<int, tuple_size_v<Fds>> fd_nums{};
+    for (size_t i = 0; i < fd_nums.size(); ++i) {
+        fd_nums[i] = _fds[i].fd_num();
+    }
+
+    char tag = 'P';
+    iovec iov{&tag, 1};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(fd_nums))]{};
+
+    msghdr message{};
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+
+    cmsghdr *cmsg = CMSG_FIRSTHDR(&message);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fd_nums));
+    memcpy(CMSG_DATA(cmsg), fd_nums.data(), sizeof(fd_nums));
+
+    SystemCall("sendmsg", static_cast<int>(::sendmsg(socket.fd_num(), &message, 0)));
+}
+
+//! \param[in] socket is a Unix-domain socket connected to the peer, which calls send_to()
+SharedPacketChannel SharedPacketChannel::receive_from(const LocalStreamSocket &socket) {
+    constexpr size_t FDS = tuple_size_v<Fds>;
+
+    char tag = 0;
+    iovec iov{&tag, 1};
+    alignas(cmsghdr) char control[CMSG_SPACE(FDS * sizeof(int))]{};
+
+    msghdr message{};
+    message.msg_iov = &iov;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+
+    const int received =
+        SystemCall("recvmsg", static_cast<int>(::recvmsg(socket.fd_num(), &message, MSG_CMSG_CLOEXEC)));
+
+    // own every fd that arrived before checking anything else, so that a malformed message leaks none
+    vector<FileDescriptor> passed;
+    for (cmsghdr *cmsg = CMSG_FIRSTHDR(&message); cmsg != nullptr; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET or cmsg->cmsg_type != SCM_RIGHTS) {
+            continue;
+        }
+        const size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        for (size_t i = 0; i < count; ++i) {
+            int fd_num = -1;
+            memcpy(&fd_num, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(fd_num));
+            passed.emplace_back(fd_num);
+        }
+    }
+
+    // MSG_CTRUNC: the peer sent more than a channel's fds (the kernel closed the ones that did not fit)
+    if (received != 1 or tag != 'P' or (message.msg_flags & MSG_CTRUNC) or passed.size() != FDS) {
+        throw runtime_error("SharedPacketChannel: peer did not send a packet channel");
+    }
+
+    Fds fds{move(passed[0]), move(passed[1]), move(passed[2]), move(passed[3]), move(passed[4])};
+    return {move(fds), false};
+}
+
+//! \returns the slot's packet bytes (Config::slot_size of them), or `nullptr` if every slot is in use
+char *SharedPacketChannel::reserve() {
+    const uint64_t w = _tx.ring->write_index.load(memory_order_relaxed);
+    if (w - _tx.ring->read_index.load(memory_order_acquire) == _config.slots) {
+        return nullptr;
+    }
+    return slot(_tx, w) + SLOT_DATA;
+}
+
+//! \param[in] len is the length of the packet built in the reserved slot
+void SharedPacketChannel::commit(const size_t len) {
+    if (len > _config.slot_size) {
+        throw runtime_error("SharedPacketChannel: packet larger than a slot");
+    }
+    const uint64_t w = _tx.ring->write_index.load(memory_order_relaxed);
+    if (w - _tx.ring->read_index.load(memory_order_acquire) == _config.slots) {
+        throw runtime_error("SharedPacketChannel: commit without a reserved slot");
+    }
+    const uint32_t length = len;
+    memcpy(slot(_tx, w), &length, sizeof(length));
+    _tx.ring->write_index.store(w + 1, memory_order_release);
+
+    // ring the receiver's doorbell if it had received everything (and so may be waiting)
+    atomic_thread_fence(memory_order_seq_cst);
+    if (_tx.ring->read_index.load(memory_order_relaxed) == w) {
+        _tx.data.ring();
+    }
+}
+
+//! \param[in] packet is the packet to send (at most Config::slot_size bytes)
+bool SharedPacketChannel::send(string_view packet) {
+    if (packet.size() > _config.slot_size) {
+        throw runtime_error("SharedPacketChannel: packet larger than a slot");
+    }
+    char *const data = reserve();
+    if (data == nullptr) {
+        return false;
+    }
+    memcpy(data, packet.data(), packet.size());
+    commit(packet.size());
+    return true;
+}
+
+void SharedPacketChannel::wait_writable() {
+    while (true) {
+        atomic_thread_fence(memory_order_seq_cst);
+        if (_tx.ring->write_index.load(memory_order_relaxed) - _tx.ring->read_index.load(memory_order_acquire) <
+            _config.slots) {
+            return;
+        }
+        _tx.space.wait();
+    }
+}
+
+optional<string_view> SharedPacketChannel::front() const {
+    const uint64_t r = _rx.ring->read_index.load(memory_order_relaxed);
+    if (r == _rx.ring->write_index.load(memory_order_acquire)) {
+        return {};
+    }
+    const char *const packet = slot(_rx, r);
+    uint32_t length = 0;
+    memcpy(&length, packet, sizeof(length));
+    if (length > _config.slot_size) {
+        throw runtime_error("SharedPacketChannel: corrupt packet length");
+    }
+    return string_view{packet + SLOT_DATA, length};
+}
+
+void SharedPacketChannel::pop() {
+    const uint64_t r = _rx.ring->read_index.load(memory_order_relaxed);
+    if (r == _rx.ring->write_index.load(memory_order_acquire)) {
+        throw runtime_error("SharedPacketChannel::pop: no packet");
+    }
+    _rx.ring->read_index.store(r + 1, memory_order_release);
+
+    // ring the sender's doorbell if it had filled the ring (and so may be waiting)
+    atomic_thread_fence(memory_order_seq_cst);
+    if (_rx.ring->write_index.load(memory_order_relaxed) - r == _config.slots) {
+        _rx.space.ring();
+    }
+}
+
+size_t SharedPacketChannel::packets_waiting() const {
+    return _rx.ring->write_index.load(memory_order_acquire) - _rx.ring->read_index.load(memory_order_relaxed);
+}
+
+void SharedPacketChannel::wait_readable() {
+    while (true) {
+        atomic_thread_fence(memory_order_seq_cst);
+        if (packets_waiting() > 0) {
+            return;
+        }
+        _rx.data.wait();
+    }
+}
@@ -0,0 +1,132 @@
+#ifndef SPONGE_LIBSPONGE_PACKET_CHANNEL_HH
+#define SPONGE_LIBSPONGE_PACKET_CHANNEL_HH
+
+#include "doorbell.hh"
+#include "file_descriptor.hh"
+#include "socket.hh"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+//! \brief A bidirectional packet channel between two processes over shared memory
+//! \details The two ends share one [memfd](\ref man2::memfd_create) region holding two rings of
+//! fixed-size packet slots, one per direction. Each ring has one producer and one consumer, which
+//! own its two indices, so packets move without locks, system calls, or kernel copies while the ring
+//! is neither empty nor full: a sender builds a packet in place (reserve() and commit(), or send()),
+//! and a receiver reads it in place (front() and pop()). Like ByteRing, each ring has two eventfd
+//! doorbells, rung only when a consumer may be waiting on an empty ring or a producer on a full one.
+//!
+//! The creating process calls create() and passes the channel's fds to its peer over a Unix-domain
+//! socket with send_to(); the peer calls receive_from(). In an EventLoop, a rule on data_fd() (whose
+//! callback calls clear_data_ready() and then drains the ring) treats the channel like any other fd.
+class SharedPacketChannel {
+  public:
+    //! Layout of a channel, fixed when it is created
+    struct Config {
+        uint32_t slots = 1024;      //!< Packets each ring can hold (rounded up to a power of two)
+        uint32_t slot_size = 2048;  //!< Largest packet, in bytes
+    };
+
+  private:
+    struct Header;  // layout of the channel, at the start of the shared region
+    struct Ring;    // indices of one direction's ring, in the shared region
+
+    //! Unmaps the shared region
+    struct Unmap {
+        size_t length = 0;
+        void operator()(char *addr) const;
+    };
+
+    //! One direction: the ring, its slots, and its doorbells
+    struct Direction {
+        Ring *ring;      //!< Indices, in the shared region
+        char *slots;     //!< First slot, in the shared region
+        Doorbell data;   //!< Rung when an empty ring gains a packet
+        Doorbell space;  //!< Rung when a full ring frees a slot
+    };
+
+    //! The memfd, then the data and space doorbells of ring 0 and of ring 1 (as passed by send_to())
+    using Fds = std::array<FileDescriptor, 5>;
+
+    Fds _fds;                              //!< The memfd and the doorbells
+    std::unique_ptr<char, Unmap> _region;  //!< Our mapping of the memfd
+    Config _config;                        //!< Slots per ring and largest packet
+    size_t _stride;                        //!< Bytes from one slot to the next
+    Direction _tx;                         //!< The ring we send on
+    Direction _rx;                         //!< The ring we receive on
+
+    //! Map the memfd in `fds`; the creator sends on ring 0, its peer on ring 1
+    SharedPacketChannel(Fds fds, const bool creator);
+
+    //! Map and check the shared region; the creator also constructs the rings
+    static std::unique_ptr<char, Unmap> map(const FileDescriptor &memory, const bool creator);
+
+    //! One direction's ring, slots, and doorbells
+    Direction direction(const size_t ring_index) const;
+
+    //! The slot for index `index` of `direction`'s ring
+    char *slot(const Direction &direction, const uint64_t index) const;
+
+  public:
+    //! Create a channel; the other end is obtained by a peer process with receive_from()
+    static SharedPacketChannel create(const Config &config);
+
+    //! Pass the fds of this channel (created by create()) to a peer process over `socket`
+    void send_to(const LocalStreamSocket &socket) const;
+
+    //! Receive the other end of a channel that a peer passed with send_to()
+    static SharedPacketChannel receive_from(const LocalStreamSocket &socket);
+
+    //! The channel's layout
+    const Config &config() const { return _config; }
+
+    //! \name Sending
+    //!@{
+
+    //! A slot to build the next packet in (Config::slot_size bytes), or `nullptr` if the ring is full
+    char *reserve();
+
+    //! Send the packet built in the slot returned by reserve(), which holds `len` bytes
+    void commit(const size_t len);
+
+    //! Copy `packet` into a slot and send it; returns `false` (sending nothing) if the ring is full
+    bool send(std::string_view packet);
+
+    //! Block until a slot is free
+    void wait_writable();
+
+    //! Readable when a slot may be free again; for EventLoop rules
+    const FileDescriptor &space_fd() const { return _tx.space; }
+
+    //! Reset space_fd() (call before sending, in an EventLoop callback on space_fd())
+    void clear_space_ready() { _tx.space.clear(); }
+    //!@}
+
+    //! \name Receiving
+    //!@{
+
+    //! The oldest received packet, still in its slot, or none if the ring is empty
+    std::optional<std::string_view> front() const;
+
+    //! Release the oldest received packet's slot to the sender
+    void pop();
+
+    //! Number of packets waiting to be received
+    size_t packets_waiting() const;
+
+    //! Block until a packet is waiting
+    void wait_readable();
+
+    //! Readable when a packet may be waiting; for EventLoop rules
+    const FileDescriptor &data_fd() const { return _rx.data; }
+
+    //! Reset data_fd() (call before receiving, in an EventLoop callback on data_fd())
+    void clear_data_ready() { _rx.data.clear(); }
+    //!@}
+};
+
+#endif  // SPONGE_LIBSPONGE_PACKET_CHANNEL_HH
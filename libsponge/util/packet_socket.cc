@@ -0,0 +1,182 @@
+#include "packet_socket.hh"
+
+#include "util.hh"
+
+#include <arpa/inet.h>
+#include <cstring>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <net/if.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <vector>
+
+using namespace std;
+
+//! Offset of a transmitted frame's data from the start of its slot
+static constexpr size_t TX_DATA_OFFSET = TPACKET_ALIGN(sizeof(tpacket3_hdr));
+
+struct PacketRingSocket::Ring {
+    char *base;
+    size_t length;
+    vector<bool> held;  //!< Receive blocks delivered whose Buffers are not all destroyed yet
+
+    Ring(char *base_, const size_t length_, const size_t rx_blocks) : base(base_), length(length_), held(rx_blocks) {}
+    ~Ring() { ::munmap(base, length); }
+
+    Ring(const Ring &other) = delete;
+    Ring &operator=(const Ring &other) = delete;
+};
+
+struct PacketRingSocket::BlockRelease {
+    shared_ptr<Ring> ring;
+    size_t index;
+
+    void operator()(const void *block) const {
+        ring->held[index] = false;
+        auto *desc = static_cast<tpacket_block_desc *>(const_cast<void *>(block));
+        __atomic_store_n(&desc->hdr.bh1.block_status, TP_STATUS_KERNEL, __ATOMIC_RELEASE);
+    }
+};
+
+//! Set a SOL_PACKET socket option
+template <typename T>
+static void set_packet_option(const FileDescriptor &fd, const int option, const T &value) {
+    SystemCall("setsockopt", ::setsockopt(fd.fd_num(), SOL_PACKET, option, &value, sizeof(value)));
+}
+
+//! \param[in] interface is the name of the network interface to capture from and transmit on
+//! \param[in] config gives the sizes of the rings
+PacketRingSocket::PacketRingSocket(const string &interface, const Config &config)
+    : FileDescriptor(SystemCall("socket", ::socket(AF_PACKET, SOCK_RAW | SOCK_CLOEXEC, htons(ETH_P_ALL))))
+    , _config(config)
+    , _ring()
+    , _tx_slots(0) {
+    if (config.frame_size == 0 or config.block_size % config.frame_size != 0 or
+        config.frame_size <= TX_DATA_OFFSET) {
+        throw runtime_error("PacketRingSocket: block size must be a multiple of a (large enough) frame size");
+    }
+    const unsigned int ifindex = ::if_nametoindex(interface.c_str());
+    if (ifindex == 0) {
+        throw unix_error("if_nametoindex " + interface);
+    }
+
+    set_packet_option(*this, PACKET_VERSION, int{TPACKET_V3});
+
+    tpacket_req3 rx{};
+    rx.tp_block_size = config.block_size;
+    rx.tp_block_nr = config.rx_blocks;
+    rx.tp_frame_size = config.frame_size;
+    rx.tp_frame_nr = config.block_size / config.frame_size * config.rx_blocks;
+    rx.tp_retire_blk_tov = config.block_timeout_ms;
+    set_packet_option(*this, PACKET_RX_RING, rx);
+
+    tpacket_req3 tx{};
+    tx.tp_block_size = config.block_size;
+    tx.tp_block_nr = config.tx_blocks;
+    tx.tp_frame_size = config.frame_size;
+    tx.tp_frame_nr = config.block_size / config.frame_size * config.tx_blocks;
+    set_packet_option(*this, PACKET_TX_RING, tx);
+    _tx_slots = tx.tp_frame_nr;
+
+    const size_t length = size_t{config.block_size} * (config.rx_blocks + config.tx_blocks);
+    void *base = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd_num(), 0);
+    if (base == MAP_FAILED) {
+        throw unix_error("mmap");
+    }
+    _ring = make_shared<Ring>(static_cast<char *>(base), length, config.rx_blocks);
+
+    sockaddr_ll address{};
+    address.sll_family = AF_PACKET;
+    address.sll_protocol = htons(ETH_P_ALL);
+    address.sll_ifindex = ifindex;
+    SystemCall("bind", ::bind(fd_num(), reinterpret_cast<sockaddr *>(&address), sizeof(address)));
+}
+
+//! \param[in] interface is the name of the network interface to capture from and transmit on
+PacketRingSocket::PacketRingSocket(const string &interface) : PacketRingSocket(interface, Config{}) {}
+
+char *PacketRingSocket::rx_block(const size_t index) const { return _ring->base + index * _config.block_size; }
+
+char *PacketRingSocket::tx_slot(const size_t index) const {
+    return _ring->base + size_t{_config.rx_blocks} * _config.block_size + index * _config.frame_size;
+}
+
+//! \param[in] handler is called with each frame, in order
+//! \param[in] max_blocks is the most blocks to deliver
+//! \details A block whose Buffers are all destroyed by the time `handler` returns (e.g., because it
+//! copies or parses each frame and keeps nothing) goes back to the kernel right away. The kernel fills
+//! blocks in order, so holding on to a block's Buffers for long stalls the ring once it wraps around:
+//! receive() then delivers nothing, and (like a read that returns `EAGAIN`) does not count as a read,
+//! so an EventLoop rule on the socket reports the busy wait instead of spinning.
+size_t PacketRingSocket::receive(const FrameHandler &handler, const size_t max_blocks) {
+    size_t frames = 0;
+    size_t blocks = 0;
+    for (; blocks < max_blocks; ++blocks) {
+        const size_t index = _rx_next;
+        auto *desc = reinterpret_cast<tpacket_block_desc *>(rx_block(index));
+        if (_ring->held[index] or
+            (__atomic_load_n(&desc->hdr.bh1.block_status, __ATOMIC_ACQUIRE) & TP_STATUS_USER) == 0) {
+            break;
+        }
+        _rx_next = (index + 1) % _config.rx_blocks;
+
+        _ring->held[index] = true;
+        const shared_ptr<const void> owner{desc, BlockRelease{_ring, index}};
+
+        const char *frame = rx_block(index) + desc->hdr.bh1.offset_to_first_pkt;
+        for (uint32_t i = 0; i < desc->hdr.bh1.num_pkts; ++i) {
+            const auto *header = reinterpret_cast<const tpacket3_hdr *>(frame);
+            handler(Buffer{owner, {frame + header->tp_mac, header->tp_snaplen}});
+            frame += header->tp_next_offset;
+            ++frames;
+        }
+    }
+    register_would_block(blocks == 0);
+    if (blocks > 0) {
+        register_read();
+    }
+    return frames;
+}
+
+size_t PacketRingSocket::max_frame_size() const { return _config.frame_size - TX_DATA_OFFSET; }
+
+//! \param[in] frame is the Ethernet frame to transmit (at most max_frame_size() bytes)
+bool PacketRingSocket::send(const string_view frame) {
+    if (frame.size() > max_frame_size()) {
+        throw runtime_error("PacketRingSocket: frame larger than a transmit slot");
+    }
+    auto *header = reinterpret_cast<tpacket3_hdr *>(tx_slot(_tx_next));
+    const auto status = __atomic_load_n(&header->tp_status, __ATOMIC_ACQUIRE);
+    if (status & TP_STATUS_WRONG_FORMAT) {
+        throw runtime_error("PacketRingSocket: the kernel rejected a transmitted frame");
+    }
+    if (status != TP_STATUS_AVAILABLE) {
+        return false;  // still waiting to be sent
+    }
+
+    memcpy(tx_slot(_tx_next) + TX_DATA_OFFSET, frame.data(), frame.size());
+    header->tp_len = frame.size();
+    header->tp_snaplen = frame.size();
+    header->tp_next_offset = 0;
+    __atomic_store_n(&header->tp_status, TP_STATUS_SEND_REQUEST, __ATOMIC_RELEASE);
+
+    _tx_next = (_tx_next + 1) % _tx_slots;
+    ++_tx_queued;
+    return true;
+}
+
+void PacketRingSocket::flush() {
+    if (_tx_queued == 0) {
+        return;
+    }
+    const int ret =
+        SystemCall("sendto", static_cast<int>(::sendto(fd_num(), nullptr, 0, MSG_DONTWAIT, nullptr, 0)), EAGAIN);
+    register_would_block(ret < 0);
+    if (ret < 0) {
+        return;  // the frames stay queued for the next flush()
+    }
+    _tx_queued = 0;
+    register_write();
+}
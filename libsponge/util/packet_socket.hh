@@ -0,0 +1,79 @@
+#ifndef SPONGE_LIBSPONGE_PACKET_SOCKET_HH
+#define SPONGE_LIBSPONGE_PACKET_SOCKET_HH
+
+#include "buffer.hh"
+#include "file_descriptor.hh"
+#include "inline_function.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+
+//! \brief A raw [packet socket](\ref man7::packet) bound to one interface, with memory-mapped
+//! TPACKET_V3 receive and transmit rings
+//! \details The kernel writes received Ethernet frames straight into blocks of the receive ring and
+//! hands over a whole block at a time, so one wakeup delivers many frames with no copies or system
+//! calls. receive() passes each frame on as a Buffer that points into its block; the block goes back
+//! to the kernel once the last Buffer from it is destroyed. Frames to transmit are copied into slots
+//! of the transmit ring with send(), and flush() asks the kernel to send every queued frame at once.
+//!
+//! Like any FileDescriptor, the socket can be added to an EventLoop: it is readable when a block of
+//! received frames is ready. Opening one requires `CAP_NET_RAW`.
+class PacketRingSocket : public FileDescriptor {
+  public:
+    //! Sizes of the rings, fixed when the socket is opened
+    struct Config {
+        uint32_t block_size = 1 << 18;   //!< Bytes per block (a multiple of the page size)
+        uint32_t rx_blocks = 64;         //!< Blocks in the receive ring
+        uint32_t tx_blocks = 16;         //!< Blocks in the transmit ring
+        uint32_t frame_size = 2048;      //!< Bytes per transmit slot (a multiple of 16), header included
+        uint32_t block_timeout_ms = 10;  //!< The kernel hands over a partly filled block after this long
+    };
+
+    //! Called with each received frame (an Ethernet frame, starting with its header)
+    using FrameHandler = InlineFunction<void(Buffer)>;
+
+  private:
+    struct Ring;          // the mapping of both rings, and which receive blocks are still in use
+    struct BlockRelease;  // returns a receive block to the kernel when its last Buffer is destroyed
+
+    Config _config;
+    std::shared_ptr<Ring> _ring;  //!< Both rings (receive first), unmapped after the last block is released
+    size_t _rx_next = 0;          //!< The next receive block to look at
+    size_t _tx_next = 0;          //!< The next transmit slot to fill
+    size_t _tx_slots;             //!< Number of transmit slots
+    size_t _tx_queued = 0;        //!< Frames queued by send() since the last flush()
+
+    //! The start of receive block `index`
+    char *rx_block(const size_t index) const;
+
+    //! The header of transmit slot `index`
+    char *tx_slot(const size_t index) const;
+
+  public:
+    //! Open a packet socket for all protocols on interface `interface` (e.g., "lo" or a veth)
+    PacketRingSocket(const std::string &interface, const Config &config);
+
+    //! Open a packet socket on interface `interface`, with the default Config
+    explicit PacketRingSocket(const std::string &interface);
+
+    //! \brief Deliver the frames of up to `max_blocks` ready blocks to `handler`, without blocking
+    //! \returns the number of frames delivered
+    size_t receive(const FrameHandler &handler,
+                   const size_t max_blocks = std::numeric_limits<size_t>::max());
+
+    //! Largest frame send() accepts
+    size_t max_frame_size() const;
+
+    //! Copy `frame` into the transmit ring; returns `false` (queuing nothing) if the ring is full
+    bool send(std::string_view frame);
+
+    //! Ask the kernel to transmit every frame queued by send() (one system call)
+    //! \note If the kernel reports `EAGAIN` (see would_block()), the frames stay queued for the next flush()
+    void flush();
+};
+
+#endif  // SPONGE_LIBSPONGE_PACKET_SOCKET_HH
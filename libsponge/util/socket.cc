@@ -2,6 +2,8 @@
 
 #include "util.hh"
 
+#include <algorithm>
+#include <cerrno>
 #include <cstddef>
 #include <stdexcept>
 #include <unistd.h>
@@ -84,26 +86,43 @@ void Socket::shutdown(const int how) {
     }
 }
 
-//! \note If `mtu` is too small to hold the received datagram, this method throws a std::runtime_error
-void UDPSocket::recv(received_datagram &datagram, const size_t mtu) {
+//! \note If `mtu` is too small to hold the received datagram, this method fails with `EMSGSIZE`
+//! \details On failure, `datagram.payload` is left empty and `datagram.source_address` unchanged.
+IOResult UDPSocket::try_recv(received_datagram &datagram, const size_t mtu) {
     // receive source address and payload
     Address::Raw datagram_source_address;
     datagram.payload.resize(mtu);
 
     socklen_t fromlen = sizeof(datagram_source_address);
 
-    const ssize_t recv_len = SystemCall(
-        "recvfrom",
-        ::recvfrom(
-            fd_num(), datagram.payload.data(), datagram.payload.size(), MSG_TRUNC, datagram_source_address, &fromlen));
+    const ssize_t recv_len = ::recvfrom(
+        fd_num(), datagram.payload.data(), datagram.payload.size(), MSG_TRUNC, datagram_source_address, &fromlen);
+    const int error = recv_len < 0 ? errno : recv_len > ssize_t(mtu) ? EMSGSIZE : 0;
 
-    if (recv_len > ssize_t(mtu)) {
-        throw runtime_error("recvfrom (oversized datagram)");
+    register_would_block(error == EAGAIN);
+    datagram.truncated = error == EMSGSIZE;
+    if (error) {
+        datagram.payload.clear();
+        return IOResult::failure(error);
     }
-
     register_read();
+
     datagram.source_address = {datagram_source_address, fromlen};
     datagram.payload.resize(recv_len);
+    return IOResult::success(recv_len);
+}
+
+//! \note If `mtu` is too small to hold the received datagram, this method throws a std::runtime_error
+//! \details Throws unix_error on failure, including `EAGAIN` on a non-blocking socket with no
+//! datagram waiting; try_recv reports that without an exception.
+void UDPSocket::recv(received_datagram &datagram, const size_t mtu) {
+    const auto result = try_recv(datagram, mtu);
+    if (result.error() == EMSGSIZE) {
+        throw runtime_error("recvfrom (oversized datagram)");
+    }
+    if (not result) {
+        result.throw_error("recvfrom");
+    }
 }
 
 UDPSocket::received_datagram UDPSocket::recv(const size_t mtu) {
@@ -141,6 +160,114 @@ void UDPSocket::send(const BufferViewList &payload) {
     register_write();
 }
 
+//! \param[in,out] datagrams is filled from the front; its size is the largest batch to receive
+//! \param[in] mtu is the largest datagram accepted
+//! \returns the number of datagrams received; the payloads of the rest of `datagrams` are left empty
+//! \details Blocks only if the socket is blocking and no datagram is waiting. On a non-blocking socket
+//! with nothing to receive, returns 0 (see would_block()). Datagrams are received into a
+//! `datagrams.size() * mtu` buffer kept by the socket, then copied into the payloads, which keep their
+//! capacity; so a loop that reuses `datagrams` allocates only in its first call.
+//! \note A datagram larger than `mtu` still takes its slot, marked `truncated` with an empty payload,
+//! so that one oversized datagram does not cost the rest of the batch.
+size_t UDPSocket::recv_batch(vector<received_datagram> &datagrams, const size_t mtu) {
+    const size_t batch = datagrams.size();
+    auto &messages = _batch_messages;
+    auto &iovecs = _batch_iovecs;
+    auto &sources = _batch_sources;
+    messages.assign(batch, {});
+    iovecs.resize(batch);
+    sources.resize(batch);
+
+    // receive into the slab and copy each datagram out, instead of zero-filling every payload up to `mtu`
+    if (_batch_slab_size < batch * mtu) {
+        _batch_slab_size = batch * mtu;
+        _batch_slab.reset(new char[_batch_slab_size]);
+    }
+    for (size_t i = 0; i < batch; ++i) {
+        iovecs[i] = {_batch_slab.get() + i * mtu, mtu};
+        auto &header = messages[i].msg_hdr;
+        header.msg_name = static_cast<sockaddr *>(sources[i]);
+        header.msg_namelen = sizeof(sockaddr_storage);
+        header.msg_iov = &iovecs[i];
+        header.msg_iovlen = 1;
+    }
+
+    const int received =
+        SystemCall("recvmmsg", ::recvmmsg(fd_num(), messages.data(), batch, MSG_WAITFORONE, nullptr), EAGAIN);
+    register_would_block(received < 0);
+    if (received > 0) {
+        register_read();
+    }
+
+    const size_t count = max(received, 0);
+    for (size_t i = 0; i < batch; ++i) {
+        auto &datagram = datagrams[i];
+        datagram.truncated = i < count and (messages[i].msg_hdr.msg_flags & MSG_TRUNC);
+        if (i >= count or datagram.truncated) {
+            datagram.payload.clear();
+            continue;
+        }
+        datagram.source_address = {sources[i], messages[i].msg_hdr.msg_namelen};
+        datagram.payload.assign(_batch_slab.get() + i * mtu, messages[i].msg_len);
+    }
+    return count;
+}
+
+//! \param[in] datagrams are the datagrams to send, in order
+//! \returns the number of datagrams sent: all of them on a blocking socket, or as many as fit in
+//! the send buffer on a non-blocking one (see would_block())
+//! \details The system call's arguments are built in storage kept by the socket, so repeated batches
+//! allocate only when one needs more room than any before it.
+size_t UDPSocket::send_batch(const vector<outgoing_datagram> &datagrams) {
+    const size_t batch = datagrams.size();
+    auto &messages = _batch_messages;
+    auto &iovecs = _batch_iovecs;
+    auto &first_iovec = _batch_first_iovec;
+    messages.assign(batch, {});
+    iovecs.clear();
+    first_iovec.resize(batch + 1);
+
+    // collect every payload's iovecs first, so that pointers into `iovecs` stay valid
+    for (size_t i = 0; i < batch; ++i) {
+        first_iovec[i] = iovecs.size();
+        for (const auto &view : datagrams[i].payload.views()) {
+            iovecs.push_back({const_cast<char *>(view.data()), view.size()});
+        }
+    }
+    first_iovec[batch] = iovecs.size();
+
+    for (size_t i = 0; i < batch; ++i) {
+        auto &header = messages[i].msg_hdr;
+        const auto &destination = datagrams[i].destination;
+        if (destination.has_value()) {
+            header.msg_name = const_cast<sockaddr *>(static_cast<const sockaddr *>(*destination));
+            header.msg_namelen = destination->size();
+        }
+        header.msg_iov = iovecs.data() + first_iovec[i];
+        header.msg_iovlen = first_iovec[i + 1] - first_iovec[i];
+    }
+
+    // sendmmsg may stop early (e.g., at UIO_MAXIOV messages); continue until done or the socket is full
+    size_t sent = 0;
+    bool full = false;
+    while (sent < batch and not full) {
+        const int ret =
+            SystemCall("sendmmsg", ::sendmmsg(fd_num(), messages.data() + sent, batch - sent, 0), EAGAIN);
+        full = ret < 0;
+        const size_t end = sent + max(ret, 0);
+        for (; sent < end; ++sent) {
+            if (messages[sent].msg_len != datagrams[sent].payload.size()) {
+                throw runtime_error("datagram payload too big for sendmmsg()");
+            }
+        }
+    }
+    register_would_block(full);
+    if (sent > 0) {
+        register_write();
+    }
+    return sent;
+}
+
 // mark the socket as listening for incoming connections
 //! \param[in] backlog is the number of waiting connections to queue (see [listen(2)](\ref man2::listen))
 void TCPSocket::listen(const int backlog) { SystemCall("listen", ::listen(fd_num(), backlog)); }
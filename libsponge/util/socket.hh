@@ -6,8 +6,12 @@
 
 #include <cstdint>
 #include <functional>
+#include <memory>
+#include <optional>
 #include <string>
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <vector>
 
 //! \brief Base class for network sockets (TCP, UDP, etc.)
 //! \details Socket is generally used via a subclass. See TCPSocket and UDPSocket for usage examples.
@@ -49,6 +53,17 @@ class Socket : public FileDescriptor {
 
 //! A wrapper around [UDP sockets](\ref man7::udp)
 class UDPSocket : public Socket {
+  private:
+    //! \name Scratch storage for recv_batch and send_batch, kept so that repeated batches do not allocate
+    //!@{
+    std::vector<mmsghdr> _batch_messages{};
+    std::vector<iovec> _batch_iovecs{};
+    std::vector<Address::Raw> _batch_sources{};
+    std::vector<size_t> _batch_first_iovec{};
+    std::unique_ptr<char[]> _batch_slab{};  //!< recv_batch receives here (uninitialized, unlike a resized string)
+    size_t _batch_slab_size{0};
+    //!@}
+
   protected:
     //! \brief Construct from FileDescriptor (used by TCPOverUDPSocketAdapter)
     //! \param[in] fd is the FileDescriptor from which to construct
@@ -62,6 +77,7 @@ class UDPSocket : public Socket {
     struct received_datagram {
         Address source_address;  //!< Address from which this datagram was received
         std::string payload;     //!< UDP datagram payload
+        bool truncated = false;  //!< The datagram was larger than the mtu and was dropped (`payload` is empty)
     };
 
     //! Receive a datagram and the Address of its sender
@@ -70,11 +86,31 @@ class UDPSocket : public Socket {
     //! Receive a datagram and the Address of its sender (caller can allocate storage)
     void recv(received_datagram &datagram, const size_t mtu = 65536);
 
+    //! Like recv, but failures (including `EAGAIN`) come back as an IOResult instead of an exception
+    IOResult try_recv(received_datagram &datagram, const size_t mtu = 65536);
+
     //! Send a datagram to specified Address
     void sendto(const Address &destination, const BufferViewList &payload);
 
     //! Send datagram to the socket's connected address (must call connect() first)
     void send(const BufferViewList &payload);
+
+    //! An element of the batch passed to UDPSocket::send_batch
+    struct outgoing_datagram {
+        std::optional<Address> destination;  //!< Where to send it (none: the socket's connected address)
+        BufferViewList payload;              //!< UDP datagram payload
+    };
+
+    //! \name Batched I/O
+    //! One system call for many datagrams, for loops that serve many peers (or many segments) per wakeup
+    //!@{
+
+    //! Receive up to `datagrams.size()` datagrams with one [recvmmsg(2)](\ref man2::recvmmsg); returns how many
+    size_t recv_batch(std::vector<received_datagram> &datagrams, const size_t mtu = 65536);
+
+    //! Send `datagrams` in order with [sendmmsg(2)](\ref man2::sendmmsg); returns how many were sent
+    size_t send_batch(const std::vector<outgoing_datagram> &datagrams);
+    //!@}
 };
 
 //! \class UDPSocket
@@ -0,0 +1,26 @@
+#include "wrapping_integers.hh"
+
+using namespace std;
+
+//! Transform an "absolute" 64-bit sequence number (zero-indexed) into a WrappingInt32
+//! \param n The input absolute 64-bit sequence number
+//! \param isn The initial sequence number
+WrappingInt32 wrap(uint64_t n, WrappingInt32 isn) { return isn + static_cast<uint32_t>(n); }
+
+//! Transform a WrappingInt32 into an "absolute" 64-bit sequence number (zero-indexed)
+//! \param n The relative sequence number
+//! \param isn The initial sequence number
+//! \param checkpoint A recent absolute 64-bit sequence number
+//! \returns the 64-bit sequence number that wraps to `n` and is closest to `checkpoint`
+//!
+//! \note Each of the two streams of the TCP connection has its own ISN. One stream
+//! runs from the local TCPSender to the remote TCPReceiver and has one ISN,
+//! and the other stream runs from the remote TCPSender to the local TCPReceiver and
+//! has a different ISN.
+uint64_t unwrap(WrappingInt32 n, WrappingInt32 isn, uint64_t checkpoint) {
+    // signed distance from the checkpoint (taken modulo 2^32) to the target
+    const int32_t delta = n - wrap(checkpoint, isn);
+    const int64_t candidate = static_cast<int64_t>(checkpoint) + delta;
+    // never step below zero: the closest non-negative candidate is one wrap further up
+    return candidate < 0 ? static_cast<uint64_t>(candidate + (1LL << 32)) : static_cast<uint64_t>(candidate);
+}
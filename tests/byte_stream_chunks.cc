@@ -0,0 +1,60 @@
+#include "buffer.hh"
+#include "byte_stream.hh"
+#include "test_err_if.hh"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        {
+            // whole Buffers move into the stream and back out, without copying their bytes
+            ByteStream stream{64};
+            BufferList data{string{"hello, "}};
+            data.append(BufferList{string{"world"}});
+            const char *const first = data.buffers().front().str().data();
+            const char *const second = data.buffers().back().str().data();
+
+            test_err_if(stream.write(move(data)) != 12, "write(BufferList &&) within capacity");
+            test_err_if(data.size() != 0, "accepted Buffers left behind");
+            test_err_if(stream.bytes_written() != 12 or stream.buffer_size() != 12, "write(BufferList &&) accounting");
+
+            const BufferList chunks = stream.read_chunks(64);
+            test_err_if(chunks.concatenate() != "hello, world", "read_chunks data");
+            test_err_if(chunks.buffers().size() != 2, "read_chunks Buffers");
+            test_err_if(chunks.buffers().front().str().data() != first, "read_chunks copied");
+            test_err_if(chunks.buffers().back().str().data() != second, "read_chunks copied");
+            test_err_if(stream.bytes_read() != 12 or not stream.buffer_empty(), "read_chunks accounting");
+        }
+
+        {
+            // only what fits is taken; the rest stays in the caller's BufferList
+            ByteStream stream{10};
+            BufferList data{string{"hello"}};
+            data.append(BufferList{string{"world!!"}});
+            test_err_if(stream.write(move(data)) != 10, "write(BufferList &&) beyond capacity");
+            test_err_if(data.concatenate() != "!!", "rejected bytes");
+            test_err_if(stream.remaining_capacity() != 0 or stream.peek_output(10) != "helloworld", "stream contents");
+
+            // a Buffer split by read_chunks is shared by the chunk and the stream
+            const BufferList chunk = stream.read_chunks(7);
+            test_err_if(chunk.concatenate() != "hellowo", "read_chunks of part of a Buffer");
+            test_err_if(stream.bytes_read() != 7 or stream.peek_output(10) != "rld", "stream after a split");
+            test_err_if(stream.read_chunks(0).size() != 0, "read_chunks(0)");
+
+            test_err_if(stream.write(move(data)) != 2, "write(BufferList &&) of the rest");
+            test_err_if(stream.read(10) != "rld!!", "stream after the rest");
+            stream.end_input();
+            test_err_if(stream.read_chunks(10).size() != 0 or not stream.eof(), "read_chunks at eof");
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return err_num;
+    }
+
+    return EXIT_SUCCESS;
+}
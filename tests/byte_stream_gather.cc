@@ -0,0 +1,55 @@
+#include "buffer.hh"
+#include "byte_stream.hh"
+#include "test_err_if.hh"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <sys/uio.h>
+
+using namespace std;
+
+int main() {
+    try {
+        {
+            // the pieces of a BufferViewList are gathered into one Buffer, up to the remaining capacity
+            ByteStream stream{10};
+            const string header{"head"}, body{"bodybody"};
+            test_err_if(stream.write(BufferViewList{header, body}) != 10, "write(BufferViewList) beyond capacity");
+            test_err_if(stream.bytes_written() != 10 or stream.remaining_capacity() != 0, "accounting");
+            const BufferList chunks = stream.read_chunks(10);
+            test_err_if(chunks.buffers().size() != 1, "pieces were not gathered into one Buffer");
+            test_err_if(chunks.concatenate() != "headbodybo", "write(BufferViewList) data");
+
+            // empty pieces, and an empty list, add nothing
+            test_err_if(stream.write(BufferViewList{"", "ab", ""}) != 2, "write(BufferViewList) with empty pieces");
+            test_err_if(stream.write(BufferViewList{string_view{}}) != 0, "write of an empty BufferViewList");
+            test_err_if(stream.read_chunks(10).buffers().size() != 1, "empty pieces made a Buffer");
+        }
+
+        {
+            // an iovec array is written the same way, like writev(2)
+            ByteStream stream{100};
+            string header{"head"}, body{"body"};
+            const iovec iov[3] = {{header.data(), header.size()}, {nullptr, 0}, {body.data(), body.size()}};
+            test_err_if(stream.write(iov, 3) != 8, "write(iovec *)");
+            test_err_if(stream.write(iov, 0) != 0, "write of no iovecs");
+            test_err_if(stream.read_chunks(100).buffers().size() != 1, "iovecs were not gathered into one Buffer");
+
+            // the stream keeps its own copy of the bytes
+            stream.write(iov, 1);
+            header[0] = 'H';
+            test_err_if(stream.read(100) != "head", "write(iovec *) kept a reference to the caller's bytes");
+
+            stream.end_input();
+            test_err_if(not stream.eof(), "eof after end_input");
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return err_num;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,95 @@
+#include "tcp_config.hh"
+#include "tcp_expectation.hh"
+#include "tcp_fsm_test_harness.hh"
+#include "test_err_if.hh"
+#include "util.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+using State = TCPTestHarness::State;
+
+static constexpr unsigned NBATCHES = 64;
+static constexpr unsigned ROUNDS_PER_BATCH = 32;
+static constexpr uint16_t SWIN = TCPConfig::MAX_PAYLOAD_SIZE;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        auto random_payload = [&] {
+            string data(1 + rd() % TCPConfig::MAX_PAYLOAD_SIZE, 0);
+            generate(data.begin(), data.end(), [&] { return rd(); });
+            return data;
+        };
+
+        TCPConfig cfg{};
+        const WrappingInt32 tx_isn(rd());
+        const WrappingInt32 rx_isn(rd());
+        TCPTestHarness test = TCPTestHarness::in_established(cfg, tx_isn, rx_isn, true);
+        test_err_if(not test._flt.in_memory(), "harness is not in in-memory mode");
+
+        // open the peer's window wide enough for one segment
+        test.send_ack(rx_isn + 1, tx_isn + 1, SWIN);
+        test.execute(ExpectNoSegment{});
+
+        // each round: the peer sends data and it is ACK'd and read, then the TCP sends data and the peer ACKs it
+        WrappingInt32 tx_next = tx_isn + 1;
+        WrappingInt32 rx_next = rx_isn + 1;
+        for (unsigned batch = 0; batch < NBATCHES; ++batch) {
+            vector<unique_ptr<TCPTestStep>> steps{};
+            for (unsigned round = 0; round < ROUNDS_PER_BATCH; ++round) {
+                const string in = random_payload();
+                const string out = random_payload();
+                const uint32_t in_size = in.size();
+                const uint32_t out_size = out.size();
+
+                steps.push_back(make_unique<SendSegment>(
+                    SendSegment{}.with_ack(true).with_ackno(tx_next).with_seqno(rx_next).with_win(SWIN).with_data(
+                        string{in})));
+                rx_next = rx_next + in_size;
+                auto ack = make_unique<ExpectOneSegment>();
+                ack->with_no_flags().with_ack(true).with_ackno(rx_next).with_payload_size(0);
+                steps.push_back(move(ack));
+                steps.push_back(make_unique<ExpectData>(ExpectData{}.with_data(in)));
+
+                steps.push_back(make_unique<Write>(out));
+                auto data = make_unique<ExpectOneSegment>();
+                data->with_ack(true).with_seqno(tx_next).with_ackno(rx_next).with_data(out);
+                steps.push_back(move(data));
+                steps.push_back(make_unique<ExpectBytesInFlight>(out_size));
+                tx_next = tx_next + out_size;
+
+                steps.push_back(make_unique<SendSegment>(
+                    SendSegment{}.with_ack(true).with_ackno(tx_next).with_seqno(rx_next).with_win(SWIN)));
+                steps.push_back(make_unique<ExpectNoSegment>());
+                steps.push_back(make_unique<ExpectBytesInFlight>(0));
+                steps.push_back(make_unique<ExpectState>(State::ESTABLISHED));
+            }
+            test.execute_batch(steps, "soak batch " + to_string(batch) + " failed");
+        }
+        test_err_if(test._steps_executed.empty(), "soak recorded no steps");
+
+        // active close, ending in TIME_WAIT and then CLOSED
+        test.execute(Close{});
+        test.execute(ExpectOneSegment{}.with_fin(true).with_seqno(tx_next).with_ackno(rx_next));
+        test.send_ack(rx_next, tx_next + 1);
+        test.execute(ExpectState{State::FIN_WAIT_2});
+        test.send_fin(rx_next, tx_next + 1);
+        test.execute(ExpectOneSegment{}.with_no_flags().with_ack(true).with_ackno(rx_next + 1));
+        test.execute(ExpectState{State::TIME_WAIT});
+        test.execute(Tick(10 * cfg.rt_timeout));
+        test.execute(ExpectState{State::CLOSED});
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return err_num;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,71 @@
+#include "buffer.hh"
+#include "reassembly_batch.hh"
+#include "stream_reassembler.hh"
+#include "stream_reassembler_model.hh"
+#include "util.hh"
+
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static constexpr unsigned NREPS = 64;
+static constexpr unsigned NSEGS = 2000;
+static constexpr size_t MAX_SEG_LEN = 300;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        // segments of several flows, interleaved and out of order, pushed in batches of random size: each
+        // flow's reassembler must end up where pushing the same segments one at a time would leave it
+        for (unsigned rep_no = 0; rep_no < NREPS; ++rep_no) {
+            const size_t flows = 1 + rd() % 8;
+            const size_t capacity = 1 + rd() % 2000;
+            const size_t total = 1 + rd() % 3000;
+            vector<string> data(flows, string(total, 0));
+            vector<unique_ptr<StreamReassembler>> reassemblers;
+            vector<ReassemblerModel> models;
+            for (size_t flow = 0; flow < flows; ++flow) {
+                generate(data[flow].begin(), data[flow].end(), [&] { return rd(); });
+                reassemblers.push_back(make_unique<StreamReassembler>(capacity));
+                models.emplace_back(capacity);
+            }
+
+            ReassemblyBatch batch;
+            for (unsigned i = 0; i < NSEGS; ++i) {
+                const size_t flow = rd() % flows;
+                const size_t index = rd() % total;
+                const size_t size = rd() % min(MAX_SEG_LEN, total - index + 1);
+                const bool eof = index + size == total;
+                batch.add(*reassemblers[flow], Buffer{data[flow].substr(index, size)}, index, eof);
+                models[flow].push_substring(data[flow].substr(index, size), index, eof);
+
+                if (rd() % 32 == 0) {
+                    batch.apply();
+                    if (batch.size() != 0) {
+                        throw runtime_error("apply() left segments in the batch");
+                    }
+                    for (size_t f = 0; f < flows; ++f) {
+                        models[f].compare(*reassemblers[f], rd() % 200, "flow " + to_string(f));
+                    }
+                }
+            }
+            batch.apply();
+            for (size_t flow = 0; flow < flows; ++flow) {
+                models[flow].compare(*reassemblers[flow], total, "end of repetition " + to_string(rep_no));
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,76 @@
+#include "buffer.hh"
+#include "stream_reassembler.hh"
+#include "stream_reassembler_model.hh"
+#include "util.hh"
+
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+static constexpr unsigned NREPS = 64;
+static constexpr unsigned NSEGS = 2000;
+static constexpr size_t MAX_SEG_LEN = 600;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        // segments pushed as Buffer slices of one shared Buffer, against the model
+        for (unsigned rep_no = 0; rep_no < NREPS; ++rep_no) {
+            const size_t capacity = 1 + rd() % 4000;
+            const size_t total = 1 + rd() % 8000;
+            string data(total, 0);
+            generate(data.begin(), data.end(), [&] { return rd(); });
+            const Buffer whole{string{data}};
+
+            StreamReassembler reassembler{capacity};
+            ReassemblerModel model{capacity};
+            for (unsigned i = 0; i < NSEGS; ++i) {
+                const size_t index = rd() % total;
+                const size_t size = rd() % min(MAX_SEG_LEN, total - index + 1);
+                const bool eof = index + size == total;
+
+                Buffer segment = whole;
+                segment.remove_prefix(index);
+                segment.remove_suffix(total - index - size);
+                reassembler.push_substring(segment, index, eof);
+                model.push_substring(data.substr(index, size), index, eof);
+                model.compare(reassembler, rd() % 4 == 0 ? rd() % 100 : 0, "segment " + to_string(i));
+            }
+            model.compare(reassembler, total, "end of repetition " + to_string(rep_no));
+        }
+
+        // bytes are reassembled as slices of the Buffers they arrived in (substrings longer than a small
+        // fragment, which may be copied together), even where segments overlap
+        {
+            StreamReassembler reassembler{4000};
+            const Buffer whole{string(2000, 'x')};
+            Buffer first = whole, second = whole;
+            first.remove_suffix(1200);
+            second.remove_prefix(600);
+
+            reassembler.push_substring(second, 600, true);
+            reassembler.push_substring(first, 0, false);
+            const BufferList chunks = reassembler.stream_out().read_chunks(2000);
+            if (chunks.size() != 2000 or not reassembler.stream_out().eof()) {
+                throw runtime_error("slices of one Buffer were not reassembled");
+            }
+            for (const auto &chunk : chunks.buffers()) {
+                const char *const at = chunk.str().data();
+                if (at < whole.str().data() or at >= whole.str().data() + whole.size()) {
+                    throw runtime_error("reassembled bytes were copied out of their Buffer");
+                }
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
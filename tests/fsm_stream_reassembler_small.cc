@@ -0,0 +1,91 @@
+#include "buffer.hh"
+#include "stream_reassembler.hh"
+#include "stream_reassembler_model.hh"
+#include "util.hh"
+
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace std;
+
+static constexpr unsigned NREPS = 64;
+static constexpr size_t MAX_SMALL_LEN = 8;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        // a stream cut into tiny segments (with a few large ones), delivered in random order with
+        // duplicates, so that many small substrings are pending at once: they are coalesced and compacted
+        for (unsigned rep_no = 0; rep_no < NREPS; ++rep_no) {
+            const size_t capacity = 1 + rd() % 6000;
+            vector<tuple<size_t, size_t>> segments;
+            size_t total = 0;
+            while (total < 4000) {
+                const size_t size = rd() % 16 == 0 ? 257 + rd() % 400 : 1 + rd() % MAX_SMALL_LEN;
+                segments.emplace_back(total, size);
+                total += size;
+            }
+            const size_t unique_segments = segments.size();
+            for (size_t i = 0; i < unique_segments / 4; ++i) {
+                segments.push_back(segments[rd() % unique_segments]);
+            }
+            shuffle(segments.begin(), segments.end(), rd);
+
+            string data(total, 0);
+            generate(data.begin(), data.end(), [&] { return rd(); });
+
+            StreamReassembler reassembler{capacity};
+            ReassemblerModel model{capacity};
+            for (size_t i = 0; i < segments.size(); ++i) {
+                const auto [index, size] = segments[i];
+                const bool eof = index + size == total;
+                reassembler.push_substring(data.substr(index, size), index, eof);
+                model.push_substring(data.substr(index, size), index, eof);
+                model.compare(reassembler, rd() % 8 == 0 ? rd() % 200 : 0, "segment " + to_string(i));
+            }
+            model.compare(reassembler, total, "end of repetition " + to_string(rep_no));
+        }
+
+        // once enough small substrings are pending, they are copied together and stop pinning the
+        // (much larger) buffers they arrived in
+        {
+            constexpr size_t PIECES = 100;
+            StreamReassembler reassembler{4 * PIECES};
+            vector<weak_ptr<const string>> arrived_in;
+            for (size_t i = 0; i < PIECES; ++i) {
+                const auto packet = make_shared<const string>(4096, static_cast<char>('a' + i % 26));
+                arrived_in.push_back(packet);
+                reassembler.push_substring(Buffer{packet, string_view{*packet}.substr(0, 1)}, 2 * i + 1, false);
+            }
+            if (reassembler.unassembled_bytes() != PIECES) {
+                throw runtime_error("small pieces were not all stored");
+            }
+            if (not all_of(arrived_in.begin(), arrived_in.begin() + 64, [](const auto &p) { return p.expired(); })) {
+                throw runtime_error("compacted pieces still pin the buffers they arrived in");
+            }
+
+            string expected;
+            for (size_t i = 0; i < PIECES; ++i) {
+                reassembler.push_substring(string(1, '-'), 2 * i, false);
+                expected += '-';
+                expected += static_cast<char>('a' + i % 26);
+            }
+            if (reassembler.unassembled_bytes() != 0 or reassembler.stream_out().read(2 * PIECES) != expected) {
+                throw runtime_error("compacted pieces were not reassembled");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
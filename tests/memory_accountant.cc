@@ -0,0 +1,67 @@
+#include "byte_stream.hh"
+#include "memory_accountant.hh"
+#include "stream_reassembler.hh"
+#include "test_err_if.hh"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+int main() {
+    try {
+        auto &accountant = MemoryAccountant::global();
+        test_err_if(accountant.usage() != 0, "usage before anything is buffered");
+
+        {
+            // limits far below MemoryAccountant::BATCH: this thread's charges must still count right away
+            accountant.set_limits(1000, 2000);
+            StreamReassembler reassembler{100000};
+            for (size_t i = 1; i <= 10; ++i) {
+                reassembler.push_substring(string(500, 'x'), 1000 * i, false);
+            }
+            // a fourth piece reaches the hard limit, so each push past it drops the farthest piece again
+            test_err_if(reassembler.unassembled_bytes() != 1500, "reassembler shed too much or too little");
+            test_err_if(accountant.usage() != 1500, "usage after shedding");
+            test_err_if(accountant.pressure() != MemoryAccountant::Pressure::Soft, "pressure between the limits");
+            test_err_if(reassembler.advertised_window() != 50000, "window halfway between the limits");
+
+            // filling the gap moves 1500 bytes to the output stream, which counts too: at 2500 bytes the
+            // reassembler drops the pieces it still holds, farthest first, until usage is under the hard limit
+            reassembler.push_substring(string(1000, 'y'), 0, false);
+            test_err_if(reassembler.stream_out().buffer_size() != 1500, "assembled bytes");
+            test_err_if(reassembler.unassembled_bytes() != 0, "unassembled bytes after filling the gap");
+            test_err_if(accountant.usage() != 1500, "usage counts the output stream");
+            test_err_if(reassembler.advertised_window() != 49250, "window after assembling");
+
+            // the output stream alone can reach the hard limit, which closes the window
+            reassembler.push_substring(string(500, 'y'), 1500, false);
+            test_err_if(accountant.pressure() != MemoryAccountant::Pressure::Hard, "pressure at the hard limit");
+            test_err_if(reassembler.advertised_window() != 0, "window at the hard limit");
+
+            reassembler.stream_out().read(2000);
+            test_err_if(accountant.usage() != 0, "usage after reading");
+            accountant.set_limits(numeric_limits<size_t>::max(), numeric_limits<size_t>::max());
+        }
+        test_err_if(accountant.usage() != 0, "usage after the reassembler is destroyed");
+
+        {
+            // another thread's small charges reach the shared counter when the thread exits
+            ByteStream stream{100000};
+            thread writer([&] { stream.write(string(1000, 'z')); });
+            writer.join();
+            test_err_if(accountant.usage() != 1000, "usage after another thread exits");
+            stream.read(1000);
+            test_err_if(accountant.usage() != 0, "usage after reading another thread's bytes");
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return err_num;
+    }
+
+    return EXIT_SUCCESS;
+}
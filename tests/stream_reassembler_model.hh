@@ -0,0 +1,81 @@
+#ifndef SPONGE_STREAM_REASSEMBLER_MODEL_HH
+#define SPONGE_STREAM_REASSEMBLER_MODEL_HH
+
+#include "stream_reassembler.hh"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+//! A byte-at-a-time model of StreamReassembler, slow but obviously right, to compare it against
+class ReassemblerModel {
+    size_t _capacity;
+    std::string _bytes{};           //!< Every byte received so far, by stream index
+    std::vector<bool> _held{};      //!< Which bytes of _bytes have been received
+    uint64_t _assembled = 0;        //!< Stream index of the next byte to assemble
+    uint64_t _read = 0;             //!< Bytes read out of the model
+    size_t _unassembled = 0;        //!< Bytes received at or after _assembled
+    bool _eof_known = false;        //!< Has the last byte's index been received?
+    uint64_t _eof_index = 0;        //!< One past the last byte (if _eof_known)
+
+  public:
+    explicit ReassemblerModel(const size_t capacity) : _capacity(capacity) {}
+
+    void push_substring(const std::string &data, const uint64_t index, const bool eof) {
+        const uint64_t window_end = _read + _capacity;
+        if (eof and index + data.size() <= window_end) {
+            _eof_known = true;
+            _eof_index = index + data.size();
+        }
+        for (size_t i = 0; i < data.size(); ++i) {
+            const uint64_t at = index + i;
+            if (at < _assembled or at >= window_end) {
+                continue;
+            }
+            if (at >= _bytes.size()) {
+                _bytes.resize(at + 1);
+                _held.resize(at + 1);
+            }
+            if (not _held[at]) {
+                _bytes[at] = data[i];
+                _held[at] = true;
+                ++_unassembled;
+            }
+        }
+        while (_assembled < _held.size() and _held[_assembled]) {
+            ++_assembled;
+            --_unassembled;
+        }
+    }
+
+    size_t unassembled_bytes() const { return _unassembled; }
+
+    std::string read(const size_t len) {
+        const size_t n = std::min<uint64_t>(len, _assembled - _read);
+        const std::string ret = _bytes.substr(_read, n);
+        _read += n;
+        return ret;
+    }
+
+    bool eof() const { return _eof_known and _assembled == _eof_index and _read == _assembled; }
+
+    //! Read `len` bytes from both `reassembler` and the model, and throw if anything differs
+    void compare(StreamReassembler &reassembler, const size_t len, const std::string &context) {
+        if (reassembler.unassembled_bytes() != unassembled_bytes()) {
+            throw std::runtime_error(context + ": unassembled_bytes() is " +
+                                     std::to_string(reassembler.unassembled_bytes()) + ", model has " +
+                                     std::to_string(unassembled_bytes()));
+        }
+        if (reassembler.stream_out().read(len) != read(len)) {
+            throw std::runtime_error(context + ": assembled bytes differ from the model's");
+        }
+        if (reassembler.stream_out().eof() != eof()) {
+            throw std::runtime_error(context + ": eof() differs from the model's");
+        }
+    }
+};
+
+#endif  // SPONGE_STREAM_REASSEMBLER_MODEL_HH
@@ -56,6 +56,13 @@ string TestFD::TestRFD::read() {
     return ret;
 }
 
+//! \param[in] in_memory selects the in-process queue instead of a SOCK_SEQPACKET socket pair
+TestFdAdapter::TestFdAdapter(const bool in_memory) {
+    if (not in_memory) {
+        _fd.emplace();
+    }
+}
+
 //! \param[in] seg is the TCPSegment to configure
 void TestFdAdapter::config_segment(TCPSegment &seg) {
     const auto &cfg = config();
@@ -67,7 +74,32 @@ void TestFdAdapter::config_segment(TCPSegment &seg) {
 //! \param[in] seg is the TCPSegment to write
 void TestFdAdapter::write(TCPSegment &seg) {
     config_segment(seg);
-    TestFD::write(seg.serialize());
+    if (_fd.has_value()) {
+        _fd->write(seg.serialize());
+        return;
+    }
+    _queue.push_back(seg.serialize().concatenate());
+}
+
+//! \returns `true` if a segment is waiting to be read
+bool TestFdAdapter::can_read() const { return _fd.has_value() ? _fd->can_read() : not _queue.empty(); }
+
+//! \returns the serialized segment that was written least recently and not yet read
+string TestFdAdapter::read() {
+    if (_fd.has_value()) {
+        return _fd->read();
+    }
+
+    if (_queue.empty()) {
+        throw runtime_error("TestFdAdapter: read with no segment queued (the socket would block forever).");
+    }
+    string ret = move(_queue.front());
+    _queue.pop_front();
+    if (ret.size() > TestFD::MAX_RECV) {
+        throw runtime_error("TestFD unexpectedly got truncated packet.");
+    }
+
+    return ret;
 }
 
 //! \param[in] seqno is the sequence number of the segment
@@ -141,6 +173,19 @@ void TCPTestHarness::send_data(const WrappingInt32 seqno, const WrappingInt32 ac
                 .with_win(DEFAULT_TEST_WINDOW));
 }
 
+void TCPTestHarness::print_failure(const string &failed, const exception &e, const string &note) const {
+    cerr << "Test Failure on expectation:\n\t" << failed;
+    cerr << "\n\nFailure message:\n\t" << e.what();
+    cerr << "\n\nList of steps that executed successfully:";
+    for (const string &s : _steps_executed) {
+        cerr << "\n\t" << s;
+    }
+    cerr << endl << endl;
+    if (note.size() > 0) {
+        cerr << "Note:\n\t" << note << endl << endl;
+    }
+}
+
 void TCPTestHarness::execute(const TCPTestStep &step, std::string note) {
     try {
         step.execute(*this);
@@ -150,18 +195,30 @@ void TCPTestHarness::execute(const TCPTestStep &step, std::string note) {
         }
         _steps_executed.emplace_back(step.to_string());
     } catch (const TCPExpectationViolation &e) {
-        cerr << "Test Failure on expectation:\n\t" << step.to_string();
-        cerr << "\n\nFailure message:\n\t" << e.what();
-        cerr << "\n\nList of steps that executed successfully:";
-        for (const string &s : _steps_executed) {
-            cerr << "\n\t" << s;
+        print_failure(step.to_string(), e, note);
+        throw e;
+    }
+}
+
+void TCPTestHarness::execute_batch(const vector<unique_ptr<TCPTestStep>> &steps, std::string note) {
+    size_t i = 0;
+    try {
+        for (; i < steps.size(); ++i) {
+            steps[i]->execute(*this);
+            while (not _fsm.segments_out().empty()) {
+                _flt.write(_fsm.segments_out().front());
+                _fsm.segments_out().pop();
+            }
         }
-        cerr << endl << endl;
-        if (note.size() > 0) {
-            cerr << "Note:\n\t" << note << endl << endl;
+    } catch (const TCPExpectationViolation &e) {
+        // only now is it worth formatting the steps that succeeded
+        for (size_t j = 0; j < i; ++j) {
+            _steps_executed.emplace_back(steps[j]->to_string());
         }
+        print_failure(steps[i]->to_string(), e, note);
         throw e;
     }
+    _steps_executed.emplace_back("Batch of " + to_string(steps.size()) + " steps");
 }
 
 TCPSegment TCPTestHarness::expect_seg(const ExpectSegment &expectation, std::string note) {
@@ -170,22 +227,14 @@ TCPSegment TCPTestHarness::expect_seg(const ExpectSegment &expectation, std::str
         _steps_executed.emplace_back(expectation.to_string());
         return ret;
     } catch (const TCPExpectationViolation &e) {
-        cerr << "Test Failure on expectation:\n\t" << expectation.description() << "\nFailure message:\n\t" << e.what();
-        cerr << "\n\nList of steps that executed successfully:";
-        for (const string &s : _steps_executed) {
-            cerr << "\n\t" << s;
-        }
-        cerr << endl << endl;
-        if (note.size() > 0) {
-            cerr << "Note:\n\t" << note << endl << endl;
-        }
+        print_failure(expectation.description(), e, note);
         throw e;
     }
 }
 
 //! Create a FSM in the "LISTEN" state.
-TCPTestHarness TCPTestHarness::in_listen(const TCPConfig &cfg) {
-    TCPTestHarness h{cfg};
+TCPTestHarness TCPTestHarness::in_listen(const TCPConfig &cfg, const bool in_memory) {
+    TCPTestHarness h{cfg, in_memory};
     h.execute(Listen{});
     return h;
 }
@@ -194,10 +243,10 @@ TCPTestHarness TCPTestHarness::in_listen(const TCPConfig &cfg) {
 //! \details The SYN has been consumed, but not ACK'd by the test harness
 //! \param[in] tx_isn is the ISN of the FSM's outbound sequence. i.e. the
 //!            seqno for the SYN.
-TCPTestHarness TCPTestHarness::in_syn_sent(const TCPConfig &cfg, const WrappingInt32 tx_isn) {
+TCPTestHarness TCPTestHarness::in_syn_sent(const TCPConfig &cfg, const WrappingInt32 tx_isn, const bool in_memory) {
     TCPConfig c{cfg};
     c.fixed_isn = tx_isn;
-    TCPTestHarness h{c};
+    TCPTestHarness h{c, in_memory};
     h.execute(Connect{});
     h.execute(ExpectOneSegment{}.with_no_flags().with_syn(true).with_seqno(tx_isn).with_payload_size(0));
     return h;
@@ -211,8 +260,9 @@ TCPTestHarness TCPTestHarness::in_syn_sent(const TCPConfig &cfg, const WrappingI
 //!            seqno for the SYN.
 TCPTestHarness TCPTestHarness::in_established(const TCPConfig &cfg,
                                               const WrappingInt32 tx_isn,
-                                              const WrappingInt32 rx_isn) {
-    TCPTestHarness h = in_syn_sent(cfg, tx_isn);
+                                              const WrappingInt32 rx_isn,
+                                              const bool in_memory) {
+    TCPTestHarness h = in_syn_sent(cfg, tx_isn, in_memory);
     // It has sent a SYN with nothing else, and that SYN has been consumed
     // We reply with ACK and SYN.
     h.send_syn(rx_isn, tx_isn + 1);
@@ -228,8 +278,9 @@ TCPTestHarness TCPTestHarness::in_established(const TCPConfig &cfg,
 //!            seqno for the SYN.
 TCPTestHarness TCPTestHarness::in_close_wait(const TCPConfig &cfg,
                                              const WrappingInt32 tx_isn,
-                                             const WrappingInt32 rx_isn) {
-    TCPTestHarness h = in_established(cfg, tx_isn, rx_isn);
+                                             const WrappingInt32 rx_isn,
+                                             const bool in_memory) {
+    TCPTestHarness h = in_established(cfg, tx_isn, rx_isn, in_memory);
     h.send_fin(rx_isn + 1, tx_isn + 1);
     h.execute(ExpectOneSegment{}.with_no_flags().with_ack(true).with_ackno(rx_isn + 2));
     return h;
@@ -243,8 +294,9 @@ TCPTestHarness TCPTestHarness::in_close_wait(const TCPConfig &cfg,
 //!            seqno for the SYN.
 TCPTestHarness TCPTestHarness::in_last_ack(const TCPConfig &cfg,
                                            const WrappingInt32 tx_isn,
-                                           const WrappingInt32 rx_isn) {
-    TCPTestHarness h = in_close_wait(cfg, tx_isn, rx_isn);
+                                           const WrappingInt32 rx_isn,
+                                           const bool in_memory) {
+    TCPTestHarness h = in_close_wait(cfg, tx_isn, rx_isn, in_memory);
     h.execute(Close{});
     h.execute(
         ExpectOneSegment{}.with_no_flags().with_fin(true).with_ack(true).with_seqno(tx_isn + 1).with_ackno(rx_isn + 2));
@@ -260,8 +312,9 @@ TCPTestHarness TCPTestHarness::in_last_ack(const TCPConfig &cfg,
 //!            seqno for the SYN.
 TCPTestHarness TCPTestHarness::in_fin_wait_1(const TCPConfig &cfg,
                                              const WrappingInt32 tx_isn,
-                                             const WrappingInt32 rx_isn) {
-    TCPTestHarness h = in_established(cfg, tx_isn, rx_isn);
+                                             const WrappingInt32 rx_isn,
+                                             const bool in_memory) {
+    TCPTestHarness h = in_established(cfg, tx_isn, rx_isn, in_memory);
     h.execute(Close{});
     h.execute(
         ExpectOneSegment{}.with_no_flags().with_fin(true).with_ack(true).with_ackno(rx_isn + 1).with_seqno(tx_isn + 1));
@@ -277,8 +330,9 @@ TCPTestHarness TCPTestHarness::in_fin_wait_1(const TCPConfig &cfg,
 //!            seqno for the SYN.
 TCPTestHarness TCPTestHarness::in_fin_wait_2(const TCPConfig &cfg,
                                              const WrappingInt32 tx_isn,
-                                             const WrappingInt32 rx_isn) {
-    TCPTestHarness h = in_fin_wait_1(cfg, tx_isn, rx_isn);
+                                             const WrappingInt32 rx_isn,
+                                             const bool in_memory) {
+    TCPTestHarness h = in_fin_wait_1(cfg, tx_isn, rx_isn, in_memory);
     h.send_ack(rx_isn + 1, tx_isn + 2);
     return h;
 }
@@ -292,8 +346,9 @@ TCPTestHarness TCPTestHarness::in_fin_wait_2(const TCPConfig &cfg,
 //!            seqno for the SYN.
 TCPTestHarness TCPTestHarness::in_closing(const TCPConfig &cfg,
                                           const WrappingInt32 tx_isn,
-                                          const WrappingInt32 rx_isn) {
-    TCPTestHarness h = in_fin_wait_1(cfg, tx_isn, rx_isn);
+                                          const WrappingInt32 rx_isn,
+                                          const bool in_memory) {
+    TCPTestHarness h = in_fin_wait_1(cfg, tx_isn, rx_isn, in_memory);
     h.send_fin(rx_isn + 1, tx_isn + 1);
     h.execute(ExpectOneSegment{}.with_no_flags().with_ack(true).with_ackno(rx_isn + 2));
     return h;
@@ -308,8 +363,9 @@ TCPTestHarness TCPTestHarness::in_closing(const TCPConfig &cfg,
 //!            seqno for the SYN.
 TCPTestHarness TCPTestHarness::in_time_wait(const TCPConfig &cfg,
                                             const WrappingInt32 tx_isn,
-                                            const WrappingInt32 rx_isn) {
-    TCPTestHarness h = in_fin_wait_1(cfg, tx_isn, rx_isn);
+                                            const WrappingInt32 rx_isn,
+                                            const bool in_memory) {
+    TCPTestHarness h = in_fin_wait_1(cfg, tx_isn, rx_isn, in_memory);
     h.send_fin(rx_isn + 1, tx_isn + 2);
     h.execute(ExpectOneSegment{}.with_no_flags().with_ack(true).with_ackno(rx_isn + 2));
     return h;
@@ -10,8 +10,11 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <deque>
 #include <exception>
+#include <memory>
 #include <optional>
+#include <string>
 #include <vector>
 
 //! \brief A wrapper class for a SOCK_SEQPACKET [Unix-domain socket](\ref man7::unix), for use by TCPTestHarness
@@ -31,13 +34,13 @@ class TestFD : public FileDescriptor {
 
     TestRFD _recv_fd;  //!< The end of a SOCK_SEQPACKET socket pair from which TCPTestHarness reads
 
-    //! Max-sized segment plus some margin
-    static constexpr size_t MAX_RECV = TCPConfig::MAX_PAYLOAD_SIZE + TCPHeader::LENGTH + 16;
-
     //! Construct from a pair of sockets
     explicit TestFD(std::pair<FileDescriptor, TestRFD> fd_pair);
 
   public:
+    //! Max-sized segment plus some margin
+    static constexpr size_t MAX_RECV = TCPConfig::MAX_PAYLOAD_SIZE + TCPHeader::LENGTH + 16;
+
     TestFD();  //!< Default constructor invokes TestFD(std::pair<FileDescriptor, TestRFD> fd_pair)
 
     void write(const BufferViewList &buffer);  //!< Write a buffer
@@ -47,12 +50,28 @@ class TestFD : public FileDescriptor {
     std::string read() { return _recv_fd.read(); }  //!< Read from TestFD::_recv_fd
 };
 
-//! An FdAdapterBase that writes to a TestFD. Does not (need to) support reading.
-class TestFdAdapter : public FdAdapterBase, public TestFD {
+//! \brief An FdAdapterBase that writes to a TestFD. Does not (need to) support reading.
+//! \details In memory mode, written segments are serialized into an in-process queue instead of a
+//! socket pair, with the same datagram semantics (one segment per read(), oversized segments are an
+//! error), so no system calls are made.
+class TestFdAdapter : public FdAdapterBase {
+  private:
+    std::optional<TestFD> _fd{};       //!< The socket pair, unless in memory mode
+    std::deque<std::string> _queue{};  //!< Serialized segments written in memory mode, oldest first
+
   public:
-    void write(TCPSegment &seg);  //!< Write a TCPSegment to the underlying TestFD
+    //! \param[in] in_memory selects the in-process queue instead of a SOCK_SEQPACKET socket pair
+    explicit TestFdAdapter(const bool in_memory = false);
+
+    void write(TCPSegment &seg);  //!< Write a TCPSegment to the underlying TestFD or queue
 
     void config_segment(TCPSegment &seg);  //!< Copy information from FdAdapterConfig into a TCPSegment
+
+    bool can_read() const;  //!< Is there a segment to read?
+
+    std::string read();  //!< Read the oldest segment written
+
+    bool in_memory() const { return not _fd.has_value(); }  //!< Is this adapter using the in-process queue?
 };
 
 //! Test adapter for TCPConnection
@@ -67,8 +86,11 @@ class TCPTestHarness {
     using State = TCPState::State;                 //!< TCP state names
     using VecIterT = std::string::const_iterator;  //!< Alias for a const iterator to a vector of bytes
 
-    //! Construct a test harness, optionally passing a configuration to the TCPConnection under test
-    explicit TCPTestHarness(const TCPConfig &c_fsm = {}) : _fsm(c_fsm) {}
+    //! \brief Construct a test harness, optionally passing a configuration to the TCPConnection under test
+    //! \param[in] in_memory is whether segments written by the TCPConnection are queued in memory
+    //!            rather than sent through a socket pair (much faster, same semantics)
+    explicit TCPTestHarness(const TCPConfig &c_fsm = {}, const bool in_memory = false)
+        : _flt(in_memory), _fsm(c_fsm) {}
 
     //! construct a FIN segment and inject it into TCPConnection
     void send_fin(const WrappingInt32 seqno, const std::optional<WrappingInt32> ackno = {});
@@ -91,6 +113,11 @@ class TCPTestHarness {
     //! is it possible to read from the TestFdAdapter (i.e., read a segment TCPConnection previously wrote)?
     bool can_read() const { return _flt.can_read(); }
 
+  private:
+    //! Print the executed steps and the failure of `failed` to cerr
+    void print_failure(const std::string &failed, const std::exception &e, const std::string &note) const;
+
+  public:
     //! \brief execute one step in a test.
     //! \param step is a representation of the step. i.e. an action or
     //!        expectation
@@ -105,14 +132,25 @@ class TCPTestHarness {
     //!        step
     TCPSegment expect_seg(const ExpectSegment &expectation, std::string note = "");
 
+    //! \brief execute a sequence of steps, stopping at the first one that fails
+    //! \details Equivalent to calling execute() on each step, except that the steps' descriptions
+    //!          are only formatted if one of them fails, and a successful batch is recorded as a
+    //!          single entry in the list of executed steps. Meant for long randomized runs.
+    //! \param steps are the steps to execute, in order
+    //! \param note is an (optional) string describing the significance of the batch
+    void execute_batch(const std::vector<std::unique_ptr<TCPTestStep>> &steps, std::string note = "");
+
     //! Create an FSM in the "LISTEN" state.
-    static TCPTestHarness in_listen(const TCPConfig &cfg);
+    static TCPTestHarness in_listen(const TCPConfig &cfg, const bool in_memory = false);
 
     //! \brief Create an FSM which has sent a SYN.
     //! \details The SYN has been consumed, but not ACK'd by the test harness
     //! \param[in] tx_isn is the ISN of the FSM's outbound sequence. i.e. the
     //!            seqno for the SYN.
-    static TCPTestHarness in_syn_sent(const TCPConfig &cfg, const WrappingInt32 tx_isn = WrappingInt32{0});
+    //! \param[in] in_memory selects the in-memory segment queue (see TCPTestHarness())
+    static TCPTestHarness in_syn_sent(const TCPConfig &cfg,
+                                      const WrappingInt32 tx_isn = WrappingInt32{0},
+                                      const bool in_memory = false);
 
     //! \brief Create an FSM with an established connection
     //! \details The mahine has sent and received a SYN, and both SYNs have been ACK'd
@@ -121,9 +159,11 @@ class TCPTestHarness {
     //!            seqno for the SYN.
     //! \param[in] rx_isn is the ISN of the FSM's inbound sequence. i.e. the
     //!            seqno for the SYN.
+    //! \param[in] in_memory selects the in-memory segment queue (see TCPTestHarness())
     static TCPTestHarness in_established(const TCPConfig &cfg,
                                          const WrappingInt32 tx_isn = WrappingInt32{0},
-                                         const WrappingInt32 rx_isn = WrappingInt32{0});
+                                         const WrappingInt32 rx_isn = WrappingInt32{0},
+                                         const bool in_memory = false);
 
     //! \brief Create an FSM in CLOSE_WAIT
     //! \details SYNs have been traded, and then the machine received and ACK'd FIN.
@@ -132,9 +172,11 @@ class TCPTestHarness {
     //!            seqno for the SYN.
     //! \param[in] rx_isn is the ISN of the FSM's inbound sequence. i.e. the
     //!            seqno for the SYN.
+    //! \param[in] in_memory selects the in-memory segment queue (see TCPTestHarness())
     static TCPTestHarness in_close_wait(const TCPConfig &cfg,
                                         const WrappingInt32 tx_isn = WrappingInt32{0},
-                                        const WrappingInt32 rx_isn = WrappingInt32{0});
+                                        const WrappingInt32 rx_isn = WrappingInt32{0},
+                                        const bool in_memory = false);
 
     //! \brief Create an FSM in LAST_ACK
     //! \details SYNs have been traded, then the machine received and ACK'd FIN, and then it sent its own FIN.
@@ -143,9 +185,11 @@ class TCPTestHarness {
     //!            seqno for the SYN.
     //! \param[in] rx_isn is the ISN of the FSM's inbound sequence. i.e. the
     //!            seqno for the SYN.
+    //! \param[in] in_memory selects the in-memory segment queue (see TCPTestHarness())
     static TCPTestHarness in_last_ack(const TCPConfig &cfg,
                                       const WrappingInt32 tx_isn = WrappingInt32{0},
-                                      const WrappingInt32 rx_isn = WrappingInt32{0});
+                                      const WrappingInt32 rx_isn = WrappingInt32{0},
+                                      const bool in_memory = false);
 
     //! \brief Create an FSM in FIN_WAIT_1
     //! \details SYNs have been traded, then the TCP sent FIN.
@@ -154,9 +198,11 @@ class TCPTestHarness {
     //!            seqno for the SYN.
     //! \param[in] rx_isn is the ISN of the FSM's inbound sequence. i.e. the
     //!            seqno for the SYN.
+    //! \param[in] in_memory selects the in-memory segment queue (see TCPTestHarness())
     static TCPTestHarness in_fin_wait_1(const TCPConfig &cfg,
                                         const WrappingInt32 tx_isn = WrappingInt32{0},
-                                        const WrappingInt32 rx_isn = WrappingInt32{0});
+                                        const WrappingInt32 rx_isn = WrappingInt32{0},
+                                        const bool in_memory = false);
 
     //! \brief Create an FSM in FIN_WAIT_2
     //! \details SYNs have been traded, then the TCP sent FIN.
@@ -165,9 +211,11 @@ class TCPTestHarness {
     //!            seqno for the SYN.
     //! \param[in] rx_isn is the ISN of the FSM's inbound sequence. i.e. the
     //!            seqno for the SYN.
+    //! \param[in] in_memory selects the in-memory segment queue (see TCPTestHarness())
     static TCPTestHarness in_fin_wait_2(const TCPConfig &cfg,
                                         const WrappingInt32 tx_isn = WrappingInt32{0},
-                                        const WrappingInt32 rx_isn = WrappingInt32{0});
+                                        const WrappingInt32 rx_isn = WrappingInt32{0},
+                                        const bool in_memory = false);
 
     //! \brief Create an FSM in CLOSING
     //! \details SYNs have been traded, then the TCP sent FIN, then received FIN
@@ -176,9 +224,11 @@ class TCPTestHarness {
     //!            seqno for the SYN.
     //! \param[in] rx_isn is the ISN of the FSM's inbound sequence. i.e. the
     //!            seqno for the SYN.
+    //! \param[in] in_memory selects the in-memory segment queue (see TCPTestHarness())
     static TCPTestHarness in_closing(const TCPConfig &cfg,
                                      const WrappingInt32 tx_isn = WrappingInt32{0},
-                                     const WrappingInt32 rx_isn = WrappingInt32{0});
+                                     const WrappingInt32 rx_isn = WrappingInt32{0},
+                                     const bool in_memory = false);
 
     //! \brief Create an FSM in TIME_WAIT
     //! \details SYNs have been traded, then the TCP sent FIN, then received FIN/ACK, and ACK'd.
@@ -187,9 +237,11 @@ class TCPTestHarness {
     //!            seqno for the SYN.
     //! \param[in] rx_isn is the ISN of the FSM's inbound sequence. i.e. the
     //!            seqno for the SYN.
+    //! \param[in] in_memory selects the in-memory segment queue (see TCPTestHarness())
     static TCPTestHarness in_time_wait(const TCPConfig &cfg,
                                        const WrappingInt32 tx_isn = WrappingInt32{0},
-                                       const WrappingInt32 rx_isn = WrappingInt32{0});
+                                       const WrappingInt32 rx_isn = WrappingInt32{0},
+                                       const bool in_memory = false);
 };
 
 #endif  // SPONGE_LIBSPONGE_TCP_FSM_TEST_HARNESS_HH
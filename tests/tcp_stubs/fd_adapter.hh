@@ -0,0 +1,35 @@
+#ifndef SPONGE_LIBSPONGE_FD_ADAPTER_HH
+#define SPONGE_LIBSPONGE_FD_ADAPTER_HH
+
+#include "tcp_config.hh"
+
+#include <cstddef>
+
+//! \brief Basic functionality for file descriptor adaptors
+//! \details See TestFdAdapter for the one used by the tests.
+class FdAdapterBase {
+  private:
+    FdAdapterConfig _cfg{};  //!< Configuration values
+    bool _listen = false;    //!< Is the connected TCP FSM in listen state?
+
+  protected:
+    FdAdapterConfig &config_mutable() { return _cfg; }
+
+  public:
+    //! Set the listening flag
+    void set_listening(const bool l) { _listen = l; }
+
+    //! Get the listening flag
+    bool listening() const { return _listen; }
+
+    //! Get the current configuration
+    const FdAdapterConfig &config() const { return _cfg; }
+
+    //! Get the current configuration (mutable)
+    FdAdapterConfig &config_mut() { return _cfg; }
+
+    //! Called periodically when time elapses
+    void tick(const size_t) {}
+};
+
+#endif  // SPONGE_LIBSPONGE_FD_ADAPTER_HH
@@ -0,0 +1,160 @@
+#include "tcp_connection.hh"
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <utility>
+
+using namespace std;
+
+TCPConnection::TCPConnection(const TCPConfig &cfg)
+    : _cfg(cfg)
+    , _isn(cfg.fixed_isn.value_or(WrappingInt32{random_device()()}))
+    , _outbound(cfg.send_capacity)
+    , _inbound(cfg.recv_capacity) {}
+
+void TCPConnection::_send(TCPSegment &&seg) {
+    if (_peer_isn.has_value()) {
+        const ByteStream &in = _inbound.stream_out();
+        seg.header().ack = true;
+        seg.header().ackno = wrap(in.bytes_written() + 1 + (in.input_ended() ? 1 : 0), _peer_isn.value());
+    }
+    seg.header().win = min<size_t>(_inbound.advertised_window(), numeric_limits<uint16_t>::max());
+    _segments_out.push(move(seg));
+}
+
+bool TCPConnection::_fill_window() {
+    if (_next_seqno == 0 and not _peer_isn.has_value()) {
+        return false;  // listening: the SYN waits for connect() or the peer's SYN
+    }
+
+    bool sent = false;
+    while (not _fin_sent) {
+        TCPSegment seg;
+        if (_next_seqno == 0) {
+            seg.header().syn = true;
+        } else if (_acked == 0) {
+            break;  // nothing but the SYN until it is acknowledged
+        } else {
+            const uint64_t window = max<uint64_t>(_peer_window, 1);
+            if (_acked + window <= _next_seqno) {
+                break;
+            }
+            const uint64_t room = _acked + window - _next_seqno;
+            const uint64_t size = min({room, uint64_t{TCPConfig::MAX_PAYLOAD_SIZE}, uint64_t{_outbound.buffer_size()}});
+            seg.payload() = Buffer{_outbound.read(size)};
+            seg.header().fin = _outbound.eof() and seg.payload().size() < room;
+        }
+
+        const size_t length = seg.length_in_sequence_space();
+        if (length == 0) {
+            break;
+        }
+        seg.header().seqno = wrap(_next_seqno, _isn);
+        _next_seqno += length;
+        _fin_sent = seg.header().fin;
+        _send(move(seg));
+        sent = true;
+    }
+    return sent;
+}
+
+void TCPConnection::connect() {
+    if (_next_seqno != 0) {
+        return;
+    }
+    TCPSegment syn;
+    syn.header().syn = true;
+    syn.header().seqno = _isn;
+    _next_seqno = 1;
+    _send(move(syn));
+}
+
+size_t TCPConnection::write(const string &data) {
+    const size_t written = _outbound.write(data);
+    _fill_window();
+    return written;
+}
+
+void TCPConnection::end_input_stream() {
+    _outbound.end_input();
+    _fill_window();
+}
+
+void TCPConnection::segment_received(const TCPSegment &seg) {
+    _since_last_segment = 0;
+    const TCPHeader &header = seg.header();
+
+    if (header.rst) {
+        _reset = true;
+        _outbound.set_error();
+        _inbound.stream_out().set_error();
+        return;
+    }
+
+    if (not _peer_isn.has_value()) {
+        if (not header.syn) {
+            return;
+        }
+        _peer_isn = header.seqno;
+    }
+
+    if (header.ack) {
+        const uint64_t ackno = unwrap(header.ackno, _isn, _next_seqno);
+        if (ackno >= _acked and ackno <= _next_seqno) {
+            _acked = ackno;
+            _peer_window = header.win;
+        }
+    }
+
+    const uint64_t seqno = unwrap(header.seqno, _peer_isn.value(), _inbound.stream_out().bytes_written());
+    if (seqno > 0 or header.syn) {
+        _inbound.push_substring(seg.payload(), seqno + (header.syn ? 1 : 0) - 1, header.fin);
+    }
+
+    // the peer finished first, so its FIN needs no time to be acknowledged
+    if (_inbound.stream_out().input_ended() and not _fin_sent) {
+        _linger = false;
+    }
+
+    if (not _fill_window() and seg.length_in_sequence_space() > 0) {
+        _send(TCPSegment{});
+    }
+}
+
+void TCPConnection::tick(const size_t ms_since_last_tick) { _since_last_segment += ms_since_last_tick; }
+
+TCPState TCPConnection::state() const {
+    using State = TCPState::State;
+    if (_reset) {
+        return State::RESET;
+    }
+    if (not active()) {
+        return State::CLOSED;
+    }
+    if (not _peer_isn.has_value()) {
+        return _next_seqno == 0 ? State::LISTEN : State::SYN_SENT;
+    }
+    if (_acked == 0) {
+        return State::SYN_RCVD;
+    }
+
+    const bool inbound_ended = _inbound.stream_out().input_ended();
+    if (not _fin_sent) {
+        return inbound_ended ? State::CLOSE_WAIT : State::ESTABLISHED;
+    }
+    if (inbound_ended) {
+        return _fin_acked() ? State::TIME_WAIT : (_linger ? State::CLOSING : State::LAST_ACK);
+    }
+    return _fin_acked() ? State::FIN_WAIT_2 : State::FIN_WAIT_1;
+}
+
+bool TCPConnection::active() const {
+    if (_reset) {
+        return false;
+    }
+    if (not(_inbound.stream_out().input_ended() and _fin_acked())) {
+        return true;
+    }
+    return _linger and _since_last_segment < 10 * size_t{_cfg.rt_timeout};
+}
@@ -0,0 +1,89 @@
+#ifndef SPONGE_LIBSPONGE_TCP_CONNECTION_HH
+#define SPONGE_LIBSPONGE_TCP_CONNECTION_HH
+
+#include "byte_stream.hh"
+#include "stream_reassembler.hh"
+#include "tcp_config.hh"
+#include "tcp_segment.hh"
+#include "tcp_state.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <queue>
+#include <string>
+
+//! \brief A minimal stand-in for the lab's TCPConnection, so that TCPTestHarness builds and runs
+//!        in a tree that does not contain the TCPSender and TCPReceiver
+//! \details It handshakes, sends what the peer's window allows, acknowledges what it receives,
+//! and closes (lingering in TIME_WAIT when it finishes first), but it never retransmits.
+//! The tests that are built against it (see tests/CMakeLists.txt) exercise the harness, not TCP.
+class TCPConnection {
+  private:
+    TCPConfig _cfg;
+    WrappingInt32 _isn;
+    ByteStream _outbound;
+    StreamReassembler _inbound;
+    std::optional<WrappingInt32> _peer_isn{};
+    std::queue<TCPSegment> _segments_out{};
+
+    uint64_t _next_seqno = 0;        //!< Absolute seqno of the next byte to send (the SYN is 0)
+    uint64_t _acked = 0;             //!< Absolute ackno most recently received from the peer
+    uint16_t _peer_window = 1;       //!< Window most recently advertised by the peer
+    bool _fin_sent = false;          //!< Has the FIN been sent?
+    bool _reset = false;             //!< Did a RST abort the connection?
+    bool _linger = true;             //!< Must the connection linger after both streams finish?
+    size_t _since_last_segment = 0;  //!< Milliseconds since a segment was received
+
+    bool _fin_acked() const { return _fin_sent and _acked == _next_seqno; }
+
+    //! Stamp `seg` with the current ackno and window and queue it for sending
+    void _send(TCPSegment &&seg);
+
+    //! Send as much as the peer's window allows: the SYN, then data, then the FIN
+    //! \returns whether anything was sent
+    bool _fill_window();
+
+  public:
+    //! Construct a new connection from a configuration
+    explicit TCPConnection(const TCPConfig &cfg);
+
+    //! Initiate a connection by sending a SYN segment
+    void connect();
+
+    //! \brief Write data to the outbound byte stream, and send it over TCP if possible
+    //! \returns the number of bytes from `data` that were actually written.
+    size_t write(const std::string &data);
+
+    //! Shut down the outbound byte stream (still allows reading incoming data)
+    void end_input_stream();
+
+    //! \brief The inbound byte stream received from the peer
+    ByteStream &inbound_stream() { return _inbound.stream_out(); }
+
+    //! Number of sequence numbers sent but not yet acknowledged
+    size_t bytes_in_flight() const { return _next_seqno - _acked; }
+
+    //! Number of bytes received but not yet reassembled
+    size_t unassembled_bytes() const { return _inbound.unassembled_bytes(); }
+
+    //! Milliseconds since the last segment was received
+    size_t time_since_last_segment_received() const { return _since_last_segment; }
+
+    //! Summarize the state of the connection
+    TCPState state() const;
+
+    //! Called when a new segment has been received from the network
+    void segment_received(const TCPSegment &seg);
+
+    //! Called periodically when time elapses
+    void tick(const size_t ms_since_last_tick);
+
+    //! TCPSegments that the TCPConnection has enqueued for transmission
+    std::queue<TCPSegment> &segments_out() { return _segments_out; }
+
+    //! Is the connection still alive in any way?
+    bool active() const;
+};
+
+#endif  // SPONGE_LIBSPONGE_TCP_CONNECTION_HH
@@ -0,0 +1,33 @@
+#include "tcp_state.hh"
+
+using namespace std;
+
+string TCPState::name() const {
+    switch (_state) {
+        case State::LISTEN:
+            return "LISTEN";
+        case State::SYN_RCVD:
+            return "SYN_RCVD";
+        case State::SYN_SENT:
+            return "SYN_SENT";
+        case State::ESTABLISHED:
+            return "ESTABLISHED";
+        case State::CLOSE_WAIT:
+            return "CLOSE_WAIT";
+        case State::LAST_ACK:
+            return "LAST_ACK";
+        case State::FIN_WAIT_1:
+            return "FIN_WAIT_1";
+        case State::FIN_WAIT_2:
+            return "FIN_WAIT_2";
+        case State::CLOSING:
+            return "CLOSING";
+        case State::TIME_WAIT:
+            return "TIME_WAIT";
+        case State::CLOSED:
+            return "CLOSED";
+        case State::RESET:
+            return "RESET";
+    }
+    return "unknown state";
+}
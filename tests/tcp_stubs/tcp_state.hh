@@ -0,0 +1,44 @@
+#ifndef SPONGE_LIBSPONGE_TCP_STATE_HH
+#define SPONGE_LIBSPONGE_TCP_STATE_HH
+
+#include <string>
+
+//! \brief Summary of a TCPConnection's internal state
+//! \details The states are the ones from [RFC 793](\ref rfc::rfc793), plus RESET for a connection
+//! that was aborted by a segment with the RST flag.
+class TCPState {
+  public:
+    //! \brief Official state names from the [TCP](\ref rfc::rfc793) specification
+    enum class State {
+        LISTEN = 0,   //!< Listening for a peer to connect
+        SYN_RCVD,     //!< Got the peer's SYN
+        SYN_SENT,     //!< Sent a SYN to initiate a connection
+        ESTABLISHED,  //!< Three-way handshake complete
+        CLOSE_WAIT,   //!< Remote side has sent a FIN, connection is half-open
+        LAST_ACK,     //!< Local side sent a FIN from CLOSE_WAIT, waiting for ACK
+        FIN_WAIT_1,   //!< Sent a FIN to the remote side, not yet ACK'd
+        FIN_WAIT_2,   //!< Received an ACK for previously-sent FIN
+        CLOSING,      //!< Received a FIN just after we sent one
+        TIME_WAIT,    //!< Both sides have sent FIN and ACK'd, waiting for 2 MSL
+        CLOSED,       //!< A connection that has terminated normally
+        RESET,        //!< A connection that terminated abnormally
+    };
+
+  private:
+    State _state;
+
+  public:
+    //! Construct from a state name
+    TCPState(const State state) : _state(state) {}
+
+    //! The state, as one of the official names
+    State state() const { return _state; }
+
+    //! Summarize the TCPState in a string
+    std::string name() const;
+
+    bool operator==(const TCPState &other) const { return _state == other._state; }
+    bool operator!=(const TCPState &other) const { return not operator==(other); }
+};
+
+#endif  // SPONGE_LIBSPONGE_TCP_STATE_HH